@@ -29,9 +29,10 @@
 class SpinningCubeWindow : public OVRWindow {
 public:
     void initializeGL() override final;
+    void updateFrame(const float, const ovrFrameTiming&) override final;
     void paintGL(const ovrEyeType, const OVRWindow::RenderTransforms&, const float) override final;
 private:
-    GLfloat _angle;
+    GLfloat _angle = 0.0f;
 };
 
 
@@ -78,9 +79,13 @@ SpinningCubeWindow::initializeGL() {
 
 
 void
-SpinningCubeWindow::paintGL(const ovrEyeType, const OVRWindow::RenderTransforms& transforms, const float dt) {
+SpinningCubeWindow::updateFrame(const float dt, const ovrFrameTiming&) {
     _angle = static_cast<GLfloat>(std::fmod(_angle + (dt * 5.0), 360.0));
+}
+
 
+void
+SpinningCubeWindow::paintGL(const ovrEyeType, const OVRWindow::RenderTransforms& transforms, const float) {
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
     glMultMatrixf(transforms.perspective.constData());
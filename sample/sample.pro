@@ -5,9 +5,7 @@ OVRWINDOW = ../src
 include($$OVRWINDOW/ovrwindow.pri)
 
 # OVRWindow source.
-INCLUDEPATH += $$OVRWINDOW
-HEADERS += $$OVRWINDOW/OVRWindow.h
-SOURCES += $$OVRWINDOW/OVRWindow.cpp
+include($$OVRWINDOW/ovrwindow-sources.pri)
 
 # The sample project's build configuration.
 TEMPLATE = app
@@ -0,0 +1,168 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "OVRFrameExporter.h"
+#include <cassert>
+#include <cstring>
+#include <new>
+#if defined(Q_OS_UNIX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+/**
+ * The alignment (in bytes) of the slot headers and each slot's pixels, i.e. a cache line.
+ */
+static const std::size_t ALIGNMENT = 64;
+
+
+/**
+ * Returns the specified size, rounded up to the alignment.
+ * @param size the size to align.
+ */
+static std::size_t
+align(const std::size_t size) {
+    return ((size + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+}
+
+
+/**
+ * Returns the name of a shared memory object, which must start with a slash.
+ * @param name the name to sanitize.
+ */
+static QByteArray
+getObjectName(const QString& name) {
+    return (name.startsWith("/") ? name : QString("/") + name).toLocal8Bit();
+}
+
+
+constexpr const char* OVRFrameExporter::Magic;
+constexpr std::uint32_t OVRFrameExporter::Version;
+
+
+OVRFrameExporter::OVRFrameExporter(const QString& name, const unsigned int slotCount, const std::size_t capacity) :
+_name(name),
+_size(getSize(slotCount, capacity)),
+_header(nullptr) {
+    // The atomics are shared with other processes, which is only valid if they are always
+    // lock-free. The 32 and 64-bit integers are either int, long or long long.
+    static_assert(
+        ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LONG_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+        "32 and 64-bit atomics must always be lock-free."
+    );
+    assert(slotCount > 0);
+#if defined(Q_OS_UNIX)
+    const auto& objectName = getObjectName(_name);
+    shm_unlink(objectName.constData());
+    const auto& descriptor = shm_open(objectName.constData(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (descriptor < 0)
+        return;
+
+    void* mapping = MAP_FAILED;
+    if (ftruncate(descriptor, static_cast<off_t>(_size)) == 0)
+        mapping = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    if (mapping == MAP_FAILED) {
+        shm_unlink(objectName.constData());
+        return;
+    }
+
+    // The object is zero-filled, so every slot's sequence number starts at zero.
+    _header = new (mapping) OVRFrameExporter::Header;
+    std::memcpy(_header->magic, Magic, sizeof(_header->magic));
+    _header->version = Version;
+    _header->slotCount = slotCount;
+    _header->capacity = capacity;
+    _header->closed.store(0, std::memory_order_relaxed);
+    for (unsigned int i = 0; i < slotCount; ++i) {
+        new (getSlot(_header, i)) OVRFrameExporter::Slot;
+        getSlot(_header, i)->sequence.store(0, std::memory_order_relaxed);
+    }
+    _header->count.store(0, std::memory_order_release);
+#endif
+}
+
+
+OVRFrameExporter::~OVRFrameExporter() {
+#if defined(Q_OS_UNIX)
+    if (_header != nullptr) {
+        _header->closed.store(1, std::memory_order_release);
+        munmap(_header, _size);
+        shm_unlink(getObjectName(_name).constData());
+    }
+#endif
+}
+
+
+bool
+OVRFrameExporter::isOpen() const {
+    return _header != nullptr;
+}
+
+
+std::size_t
+OVRFrameExporter::getCapacity() const {
+    return _header != nullptr ? _header->capacity : 0;
+}
+
+
+bool
+OVRFrameExporter::write(const OVRFrameExporter::Frame& frame, const void* const pixels) {
+    const auto& size = static_cast<std::size_t>(frame.stride) * frame.height;
+    if (_header == nullptr || size > _header->capacity)
+        return false;
+
+    const auto& index = _header->count.load(std::memory_order_relaxed);
+    const auto& slotIndex = static_cast<unsigned int>(index % _header->slotCount);
+    auto& slot = *getSlot(_header, slotIndex);
+    const auto& sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.frame = frame;
+    std::memcpy(getPixels(_header, slotIndex), pixels, size);
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    _header->count.store(index + 1, std::memory_order_release);
+    return true;
+}
+
+
+std::size_t
+OVRFrameExporter::getSize(const unsigned int slotCount, const std::size_t capacity) {
+    return align(sizeof(OVRFrameExporter::Header)) + slotCount * (align(sizeof(OVRFrameExporter::Slot)) + align(capacity));
+}
+
+
+OVRFrameExporter::Slot*
+OVRFrameExporter::getSlot(OVRFrameExporter::Header* const header, const unsigned int index) {
+    auto* const base = reinterpret_cast<unsigned char*>(header) + align(sizeof(OVRFrameExporter::Header));
+    return reinterpret_cast<OVRFrameExporter::Slot*>(base + index * align(sizeof(OVRFrameExporter::Slot)));
+}
+
+
+unsigned char*
+OVRFrameExporter::getPixels(OVRFrameExporter::Header* const header, const unsigned int index) {
+    auto* const base = reinterpret_cast<unsigned char*>(getSlot(header, header->slotCount));
+    return base + index * align(header->capacity);
+}
@@ -0,0 +1,168 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef OVRFRAMEEXPORTER_H
+#define OVRFRAMEEXPORTER_H
+
+#include <QString>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * @brief A ring of frames in POSIX shared memory, which external processes (e.g. recording
+ * or streaming daemons) can read without copying.
+ *
+ * The shared memory object starts with a header, followed by one slot header per frame
+ * in the ring, followed by each slot's pixels. As with OVRSensorSampler, each slot is
+ * protected by a sequence lock: the exporter never waits for readers. A reader reads the
+ * most recent frame in place, then checks that its slot's sequence number is unchanged.
+ * If it changed, the reader was too slow and the frame was overwritten, in which case it
+ * is simply dropped.
+ *
+ * Frames are only exported on POSIX platforms.
+ */
+class OVRFrameExporter {
+public:
+    /**
+     * @enum Format
+     * @brief A frame's pixel format. Rows are stored bottom to top, as read from OpenGL.
+     */
+    enum class Format : std::uint32_t {
+        RGBA8,
+    };
+    /**
+     * @struct Pose
+     * @brief An eye's pose, i.e. its orientation (a quaternion stored as x, y, z, w) and
+     * position (in meters).
+     */
+    struct Pose {
+        float orientation[4];
+        float position[3];
+    };
+    /**
+     * @struct Frame
+     * @brief A frame's description: its index, the time (in seconds, see ovr_GetTimeInSeconds)
+     * at which it is displayed, its pixel format and dimensions, the number of bytes per row,
+     * and the pose each eye was rendered with.
+     */
+    struct Frame {
+        std::uint64_t index;
+        double time;
+        OVRFrameExporter::Format format;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t stride;
+        OVRFrameExporter::Pose poses[2];
+    };
+    /**
+     * @struct Header
+     * @brief The shared memory object's header. The magic string and version identify the
+     * protocol, and the number of frames written so far identifies the most recent frame.
+     * The closed flag is set when the exporter is destroyed, e.g. when the ring is
+     * recreated with a larger capacity, after which readers should open it again.
+     */
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t slotCount;
+        std::uint64_t capacity;
+        std::atomic<std::uint64_t> count;
+        std::atomic<std::uint32_t> closed;
+    };
+    /**
+     * @struct Slot
+     * @brief A slot's header. The sequence number is odd while the slot is written, and is
+     * incremented twice per write.
+     */
+    struct Slot {
+        std::atomic<std::uint32_t> sequence;
+        OVRFrameExporter::Frame frame;
+    };
+    /**
+     * The protocol's magic string and version.
+     */
+    static constexpr const char* Magic = "OVRFRAME";
+    static constexpr std::uint32_t Version = 1;
+    /**
+     * @brief Create a shared memory object with the specified name, replacing any object
+     * with the same name. Use isOpen to check whether it was created successfully.
+     *
+     * @param name the shared memory object's name. A leading slash is added if need be.
+     * @param slotCount the number of frames in the ring.
+     * @param capacity the largest size (in bytes) of a frame's pixels.
+     */
+    OVRFrameExporter(const QString& name, const unsigned int slotCount, const std::size_t capacity);
+    /**
+     * The destructor. The shared memory object is marked as closed, then removed.
+     */
+    ~OVRFrameExporter();
+    /**
+     * Returns true if the shared memory object was created, false otherwise.
+     */
+    bool isOpen() const;
+    /**
+     * Return the largest size (in bytes) of a frame's pixels.
+     */
+    std::size_t getCapacity() const;
+    /**
+     * @brief Write a frame to the next slot in the ring. Returns false if the frame's pixels
+     * exceed the capacity.
+     *
+     * @param frame the frame's description.
+     * @param pixels the frame's pixels, i.e. frame.stride * frame.height bytes.
+     */
+    bool write(const OVRFrameExporter::Frame& frame, const void* const pixels);
+    /**
+     * Return the size (in bytes) of a shared memory object with the specified layout.
+     * @param slotCount the number of frames in the ring.
+     * @param capacity the largest size (in bytes) of a frame's pixels.
+     */
+    static std::size_t getSize(const unsigned int slotCount, const std::size_t capacity);
+    /**
+     * Return the header of the slot at the specified index.
+     * @param header the shared memory object's header.
+     * @param index the slot's index.
+     */
+    static OVRFrameExporter::Slot* getSlot(OVRFrameExporter::Header* const header, const unsigned int index);
+    /**
+     * Return the pixels of the slot at the specified index.
+     * @param header the shared memory object's header.
+     * @param index the slot's index.
+     */
+    static unsigned char* getPixels(OVRFrameExporter::Header* const header, const unsigned int index);
+private:
+    /**
+     * The shared memory object's name.
+     */
+    const QString _name;
+    /**
+     * The shared memory object's size (in bytes) and mapping. The header is null if the
+     * object could not be created.
+     */
+    std::size_t _size;
+    OVRFrameExporter::Header* _header;
+};
+
+#endif // OVRFRAMEEXPORTER_H
@@ -0,0 +1,151 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef OVRGLFUNCTIONS_H
+#define OVRGLFUNCTIONS_H
+
+#include <QOpenGLFunctions>
+
+
+/**
+ * @struct OVRGLCallCounts
+ * @brief The number of draw calls, state changes and uploads (buffer, texture and uniform
+ * data) that were made.
+ */
+struct OVRGLCallCounts {
+    unsigned int draws;
+    unsigned int stateChanges;
+    unsigned int uploads;
+};
+
+#if defined(OVR_GL_CALL_COUNTING)
+/**
+ * @brief OpenGL functions that count the calls made through them.
+ *
+ * The functions hide their QOpenGLFunctions counterparts, so calls made from a class
+ * that derives from OVRGLFunctions are counted without any change to its source code.
+ * Note that functions called through their global symbols (e.g. GL 3.x functions made
+ * available by GL_GLEXT_PROTOTYPES) are not counted.
+ *
+ * Call counting is enabled by adding 'ovr_gl_call_counting' to the project's CONFIG
+ * variable. When it is disabled, OVRGLFunctions is QOpenGLFunctions.
+ */
+class OVRGLFunctions : public QOpenGLFunctions {
+public:
+    OVRGLFunctions() :
+    _callCounts({0, 0, 0}) {}
+    /**
+     * Return the number of calls made since the counts were last reset.
+     */
+    const OVRGLCallCounts& getCallCounts() const {
+        return _callCounts;
+    }
+    /**
+     * Reset the call counts.
+     */
+    void resetCallCounts() {
+        _callCounts = {0, 0, 0};
+    }
+    void glDrawArrays(GLenum mode, GLint first, GLsizei count) {
+        ++_callCounts.draws;
+        QOpenGLFunctions::glDrawArrays(mode, first, count);
+    }
+    void glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices) {
+        ++_callCounts.draws;
+        QOpenGLFunctions::glDrawElements(mode, count, type, indices);
+    }
+    void glEnable(GLenum capability) {
+        ++_callCounts.stateChanges;
+        QOpenGLFunctions::glEnable(capability);
+    }
+    void glDisable(GLenum capability) {
+        ++_callCounts.stateChanges;
+        QOpenGLFunctions::glDisable(capability);
+    }
+    void glBlendFunc(GLenum source, GLenum destination) {
+        ++_callCounts.stateChanges;
+        QOpenGLFunctions::glBlendFunc(source, destination);
+    }
+    void glDepthMask(GLboolean flag) {
+        ++_callCounts.stateChanges;
+        QOpenGLFunctions::glDepthMask(flag);
+    }
+    void glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+        ++_callCounts.stateChanges;
+        QOpenGLFunctions::glViewport(x, y, width, height);
+    }
+    void glUseProgram(GLuint program) {
+        ++_callCounts.stateChanges;
+        QOpenGLFunctions::glUseProgram(program);
+    }
+    void glActiveTexture(GLenum unit) {
+        ++_callCounts.stateChanges;
+        QOpenGLFunctions::glActiveTexture(unit);
+    }
+    void glBindTexture(GLenum target, GLuint texture) {
+        ++_callCounts.stateChanges;
+        QOpenGLFunctions::glBindTexture(target, texture);
+    }
+    void glBindBuffer(GLenum target, GLuint buffer) {
+        ++_callCounts.stateChanges;
+        QOpenGLFunctions::glBindBuffer(target, buffer);
+    }
+    void glBindFramebuffer(GLenum target, GLuint framebuffer) {
+        ++_callCounts.stateChanges;
+        QOpenGLFunctions::glBindFramebuffer(target, framebuffer);
+    }
+    void glBufferData(GLenum target, qopengl_GLsizeiptr size, const void* data, GLenum usage) {
+        ++_callCounts.uploads;
+        QOpenGLFunctions::glBufferData(target, size, data, usage);
+    }
+    void glBufferSubData(GLenum target, qopengl_GLintptr offset, qopengl_GLsizeiptr size, const void* data) {
+        ++_callCounts.uploads;
+        QOpenGLFunctions::glBufferSubData(target, offset, size, data);
+    }
+    void glTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels) {
+        ++_callCounts.uploads;
+        QOpenGLFunctions::glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+    }
+    void glTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* pixels) {
+        ++_callCounts.uploads;
+        QOpenGLFunctions::glTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+    }
+    void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+        ++_callCounts.uploads;
+        QOpenGLFunctions::glUniformMatrix4fv(location, count, transpose, value);
+    }
+    void glUniform4fv(GLint location, GLsizei count, const GLfloat* value) {
+        ++_callCounts.uploads;
+        QOpenGLFunctions::glUniform4fv(location, count, value);
+    }
+private:
+    /**
+     * The number of calls made since the counts were last reset.
+     */
+    OVRGLCallCounts _callCounts;
+};
+#else
+typedef QOpenGLFunctions OVRGLFunctions;
+#endif
+
+#endif // OVRGLFUNCTIONS_H
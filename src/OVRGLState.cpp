@@ -0,0 +1,330 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "OVRGLState.h"
+#include <cassert>
+
+
+constexpr std::array<GLenum, 5> OVRGLState::CAPABILITIES;
+
+
+/**
+ * The value of a binding that is not known, which never matches an actual binding.
+ */
+static constexpr GLuint UNKNOWN_BINDING = ~0u;
+/**
+ * The value of a flag that is not known, which is neither GL_TRUE nor GL_FALSE.
+ */
+static constexpr GLboolean UNKNOWN_FLAG = 0xFF;
+/**
+ * The value of a viewport coordinate that is not known.
+ */
+static constexpr GLint UNKNOWN_VIEWPORT = -1;
+
+
+OVRGLState::Scope::Scope(OVRGLState& state) :
+_state(state),
+_values(state._values) {}
+
+
+OVRGLState::Scope::~Scope() {
+    _state.apply(_values);
+}
+
+
+OVRGLState::OVRGLState() :
+_values(),
+_current({0, 0, 0}),
+_previous({0, 0, 0}) {}
+
+
+void
+OVRGLState::bindFramebuffer(const GLuint framebuffer) {
+    if (_values.framebuffer == framebuffer) {
+        ++_current.avoided;
+    } else {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        _values.framebuffer = framebuffer;
+        ++_current.issued;
+    }
+}
+
+
+void
+OVRGLState::bindVertexArray(const GLuint vertexArray) {
+    if (_values.vertexArray == vertexArray) {
+        ++_current.avoided;
+    } else {
+        glBindVertexArray(vertexArray);
+        _values.vertexArray = vertexArray;
+        _values.elementArrayBuffer = UNKNOWN_BINDING;
+        ++_current.issued;
+    }
+}
+
+
+void
+OVRGLState::bindBuffer(const GLenum target, const GLuint buffer) {
+    GLuint* const binding =
+        target == GL_ARRAY_BUFFER ? &_values.arrayBuffer :
+        target == GL_ELEMENT_ARRAY_BUFFER ? &_values.elementArrayBuffer :
+        nullptr;
+
+    // An unknown binding (see bindVertexArray) cannot be restored.
+    if (buffer == UNKNOWN_BINDING || (binding != nullptr && *binding == buffer)) {
+        ++_current.avoided;
+    } else {
+        glBindBuffer(target, buffer);
+        if (binding != nullptr)
+            *binding = buffer;
+        ++_current.issued;
+    }
+}
+
+
+void
+OVRGLState::useProgram(const GLuint program) {
+    if (_values.program == program) {
+        ++_current.avoided;
+    } else {
+        glUseProgram(program);
+        _values.program = program;
+        ++_current.issued;
+    }
+}
+
+
+void
+OVRGLState::setActiveTexture(const GLenum unit) {
+    if (_values.activeTexture == unit) {
+        ++_current.avoided;
+    } else {
+        glActiveTexture(unit);
+        _values.activeTexture = unit;
+        ++_current.issued;
+    }
+}
+
+
+void
+OVRGLState::bindTexture(const GLuint texture) {
+    if (_values.texture == texture) {
+        ++_current.avoided;
+    } else {
+        // An unknown texture unit is left selecting the first one.
+        const auto& unit = _values.activeTexture;
+        if (unit != GL_TEXTURE0)
+            glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        if (unit == UNKNOWN_BINDING)
+            _values.activeTexture = GL_TEXTURE0;
+        else if (unit != GL_TEXTURE0)
+            glActiveTexture(unit);
+        _values.texture = texture;
+        ++_current.issued;
+    }
+}
+
+
+void
+OVRGLState::setViewport(const GLint x, const GLint y, const GLsizei width, const GLsizei height) {
+    const std::array<GLint, 4> viewport = {{x, y, width, height}};
+    if (_values.viewport == viewport) {
+        ++_current.avoided;
+    } else {
+        glViewport(x, y, width, height);
+        _values.viewport = viewport;
+        ++_current.issued;
+    }
+}
+
+
+void
+OVRGLState::setBlendFunction(const GLenum source, const GLenum destination) {
+    const std::array<GLenum, 4> blend = {{source, destination, source, destination}};
+    if (_values.blend == blend) {
+        ++_current.avoided;
+    } else {
+        glBlendFunc(source, destination);
+        _values.blend = blend;
+        ++_current.issued;
+    }
+}
+
+
+void
+OVRGLState::setDepthMask(const bool enable) {
+    const GLboolean depthMask = enable ? GL_TRUE : GL_FALSE;
+    if (_values.depthMask == depthMask) {
+        ++_current.avoided;
+    } else {
+        glDepthMask(depthMask);
+        _values.depthMask = depthMask;
+        ++_current.issued;
+    }
+}
+
+
+void
+OVRGLState::setCapability(const GLenum capability, const bool enable) {
+    const auto& index = getCapabilityIndex(capability);
+    const GLboolean flag = enable ? GL_TRUE : GL_FALSE;
+    if (index >= 0 && _values.capabilities[index] == flag) {
+        ++_current.avoided;
+    } else {
+        if (enable)
+            glEnable(capability);
+        else
+            glDisable(capability);
+        if (index >= 0)
+            _values.capabilities[index] = flag;
+        ++_current.issued;
+    }
+}
+
+
+void
+OVRGLState::synchronize() {
+    GLint value = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &value);
+    _values.framebuffer = static_cast<GLuint>(value);
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &value);
+    _values.vertexArray = static_cast<GLuint>(value);
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &value);
+    _values.arrayBuffer = static_cast<GLuint>(value);
+    glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &value);
+    _values.elementArrayBuffer = static_cast<GLuint>(value);
+    glGetIntegerv(GL_CURRENT_PROGRAM, &value);
+    _values.program = static_cast<GLuint>(value);
+
+    // The 2D texture binding is queried on the first texture unit.
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &value);
+    _values.activeTexture = static_cast<GLenum>(value);
+    if (_values.activeTexture != GL_TEXTURE0)
+        glActiveTexture(GL_TEXTURE0);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &value);
+    _values.texture = static_cast<GLuint>(value);
+    if (_values.activeTexture != GL_TEXTURE0)
+        glActiveTexture(_values.activeTexture);
+
+    glGetIntegerv(GL_VIEWPORT, _values.viewport.data());
+    const std::array<GLenum, 4> BLEND = {{GL_BLEND_SRC_RGB, GL_BLEND_DST_RGB, GL_BLEND_SRC_ALPHA, GL_BLEND_DST_ALPHA}};
+    for (std::size_t i = 0; i < BLEND.size(); ++i) {
+        glGetIntegerv(BLEND[i], &value);
+        _values.blend[i] = static_cast<GLenum>(value);
+    }
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &_values.depthMask);
+    for (std::size_t i = 0; i < CAPABILITIES.size(); ++i) {
+        _values.capabilities[i] = glIsEnabled(CAPABILITIES[i]);
+    }
+}
+
+
+void
+OVRGLState::invalidate() {
+    _values.framebuffer = UNKNOWN_BINDING;
+    _values.vertexArray = UNKNOWN_BINDING;
+    _values.arrayBuffer = UNKNOWN_BINDING;
+    _values.elementArrayBuffer = UNKNOWN_BINDING;
+    _values.program = UNKNOWN_BINDING;
+    _values.activeTexture = UNKNOWN_BINDING;
+    _values.texture = UNKNOWN_BINDING;
+    _values.viewport.fill(UNKNOWN_VIEWPORT);
+    _values.blend.fill(UNKNOWN_BINDING);
+    _values.depthMask = UNKNOWN_FLAG;
+    _values.capabilities.fill(UNKNOWN_FLAG);
+}
+
+
+unsigned int
+OVRGLState::restore() {
+    const auto values = _values;
+    synchronize();
+    const auto& count = apply(values);
+    _current.restored += count;
+    return count;
+}
+
+
+void
+OVRGLState::beginFrame() {
+    _previous = _current;
+    _current = {0, 0, 0};
+}
+
+
+unsigned int
+OVRGLState::getAvoidedCallCount() const {
+    return _previous.avoided;
+}
+
+
+unsigned int
+OVRGLState::getRestoredCallCount() const {
+    return _previous.restored;
+}
+
+
+unsigned int
+OVRGLState::apply(const OVRGLState::Values& values) {
+    // Unknown bindings are skipped by bindBuffer.
+    const auto issued = _current.issued;
+    if (values.framebuffer != UNKNOWN_BINDING)
+        bindFramebuffer(values.framebuffer);
+    if (values.vertexArray != UNKNOWN_BINDING)
+        bindVertexArray(values.vertexArray);
+    bindBuffer(GL_ARRAY_BUFFER, values.arrayBuffer);
+    bindBuffer(GL_ELEMENT_ARRAY_BUFFER, values.elementArrayBuffer);
+    if (values.program != UNKNOWN_BINDING)
+        useProgram(values.program);
+    if (values.texture != UNKNOWN_BINDING)
+        bindTexture(values.texture);
+    if (values.activeTexture != UNKNOWN_BINDING)
+        setActiveTexture(values.activeTexture);
+    if (values.viewport[2] != UNKNOWN_VIEWPORT)
+        setViewport(values.viewport[0], values.viewport[1], values.viewport[2], values.viewport[3]);
+    if (values.blend[0] == UNKNOWN_BINDING || _values.blend == values.blend) {
+        ++_current.avoided;
+    } else {
+        glBlendFuncSeparate(values.blend[0], values.blend[1], values.blend[2], values.blend[3]);
+        _values.blend = values.blend;
+        ++_current.issued;
+    }
+    if (values.depthMask != UNKNOWN_FLAG)
+        setDepthMask(values.depthMask == GL_TRUE);
+    for (std::size_t i = 0; i < CAPABILITIES.size(); ++i) {
+        if (values.capabilities[i] != UNKNOWN_FLAG)
+            setCapability(CAPABILITIES[i], values.capabilities[i] == GL_TRUE);
+    }
+    return _current.issued - issued;
+}
+
+
+int
+OVRGLState::getCapabilityIndex(const GLenum capability) {
+    for (std::size_t i = 0; i < CAPABILITIES.size(); ++i) {
+        if (CAPABILITIES[i] == capability)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
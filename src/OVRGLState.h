@@ -0,0 +1,210 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef OVRGLSTATE_H
+#define OVRGLSTATE_H
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES
+#endif
+
+#include <qopengl.h>
+#include <array>
+
+
+/**
+ * @brief A shadow copy of the OpenGL state that OVRWindow depends on.
+ *
+ * State changes made through the tracker are only forwarded to OpenGL if they differ
+ * from the shadow copy. Code that changes the state directly must be followed by a call
+ * to invalidate, which marks the shadow copy as unknown so that the next change to each
+ * value is forwarded, synchronize, which reads the tracked state back, or restore, which
+ * puts back the state that differs from the shadow copy. Only invalidate does not query
+ * OpenGL.
+ *
+ * The tracked state comprises the framebuffer, vertex array, array and element array
+ * buffer bindings, the current program, the active texture unit and the 2D texture bound to the first
+ * texture unit, the viewport, the blend function, the depth mask, as well as the blend,
+ * depth test, face culling, scissor test and stencil test capabilities.
+ */
+class OVRGLState {
+private:
+    /**
+     * The values of the tracked state.
+     */
+    struct Values {
+        GLuint framebuffer;
+        GLuint vertexArray;
+        GLuint arrayBuffer;
+        GLuint elementArrayBuffer;
+        GLuint program;
+        GLenum activeTexture;
+        GLuint texture;
+        std::array<GLint, 4> viewport;
+        std::array<GLenum, 4> blend;
+        GLboolean depthMask;
+        std::array<GLboolean, 5> capabilities;
+    };
+public:
+    /**
+     * @brief Saves the tracked state and restores it through the tracker when it goes
+     * out of scope, i.e. only the state that was actually changed is restored. Values
+     * that were unknown when the scope was entered are left as they are.
+     */
+    class Scope {
+    public:
+        explicit Scope(OVRGLState& state);
+        ~Scope();
+    private:
+        OVRGLState& _state;
+        const OVRGLState::Values _values;
+    };
+    /**
+     * @brief Instantiate a tracker. The shadow copy is undefined until synchronize is called.
+     */
+    OVRGLState();
+    /**
+     * Bind a framebuffer to GL_FRAMEBUFFER.
+     * @param framebuffer the framebuffer to bind.
+     */
+    void bindFramebuffer(const GLuint framebuffer);
+    /**
+     * @brief Bind a vertex array object.
+     *
+     * The element array buffer binding is part of the vertex array's state, so the next
+     * element array buffer binding is always forwarded.
+     * @param vertexArray the vertex array to bind.
+     */
+    void bindVertexArray(const GLuint vertexArray);
+    /**
+     * Bind a buffer. Only the GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER targets are
+     * tracked; bindings to other targets are always forwarded.
+     * @param target the binding target.
+     * @param buffer the buffer to bind.
+     */
+    void bindBuffer(const GLenum target, const GLuint buffer);
+    /**
+     * Make a program current.
+     * @param program the program to use.
+     */
+    void useProgram(const GLuint program);
+    /**
+     * Select the active texture unit.
+     * @param unit the texture unit, e.g. GL_TEXTURE0.
+     */
+    void setActiveTexture(const GLenum unit);
+    /**
+     * Bind a 2D texture to the first texture unit, regardless of the active texture unit.
+     * @param texture the texture to bind.
+     */
+    void bindTexture(const GLuint texture);
+    /**
+     * Set the viewport.
+     */
+    void setViewport(const GLint x, const GLint y, const GLsizei width, const GLsizei height);
+    /**
+     * Set the blend function for both the RGB and alpha components.
+     * @param source the source factor.
+     * @param destination the destination factor.
+     */
+    void setBlendFunction(const GLenum source, const GLenum destination);
+    /**
+     * Enable or disable writing into the depth buffer.
+     * @param enable true to enable depth writes, false to disable them.
+     */
+    void setDepthMask(const bool enable);
+    /**
+     * Enable or disable a capability. Capabilities that are not tracked are always forwarded.
+     * @param capability the capability to set.
+     * @param enable true to enable the capability, false to disable it.
+     */
+    void setCapability(const GLenum capability, const bool enable);
+    /**
+     * @brief Read the tracked state back from OpenGL.
+     *
+     * This makes one glGet call per tracked value (about 15), each of which may stall the
+     * pipeline until the commands that precede it are processed, so it should not be
+     * called more than a few times per frame.
+     */
+    void synchronize();
+    /**
+     * @brief Mark the tracked state as unknown, without querying OpenGL.
+     *
+     * The next change made through the tracker to each value is forwarded to OpenGL,
+     * and a Scope that is left after the state was invalidated sets each of its values
+     * again.
+     */
+    void invalidate();
+    /**
+     * @brief Restore the state that was changed without the tracker.
+     *
+     * The tracked state is read back from OpenGL and the values that differ from the
+     * shadow copy are set again. Returns the number of calls that were made.
+     */
+    unsigned int restore();
+    /**
+     * Begin a new frame, i.e. reset the frame's call counts.
+     */
+    void beginFrame();
+    /**
+     * Return the number of redundant calls that were avoided during the previous frame.
+     */
+    unsigned int getAvoidedCallCount() const;
+    /**
+     * Return the number of calls made during the previous frame to restore the state
+     * that was changed without the tracker.
+     */
+    unsigned int getRestoredCallCount() const;
+private:
+    /**
+     * Set the tracked state to the specified values, except those that are unknown.
+     * Returns the number of calls made.
+     * @param values the values to set.
+     */
+    unsigned int apply(const OVRGLState::Values& values);
+    /**
+     * Returns the index of a tracked capability, or -1 if it is not tracked.
+     * @param capability the capability to query.
+     */
+    static int getCapabilityIndex(const GLenum capability);
+    /**
+     * The tracked capabilities.
+     */
+    static constexpr std::array<GLenum, 5> CAPABILITIES = {{
+        GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST, GL_STENCIL_TEST
+    }};
+    /**
+     * The shadow copy.
+     */
+    OVRGLState::Values _values;
+    /**
+     * The number of calls that were made and avoided, and the number of calls that were
+     * made to restore the state, for the current and previous frames.
+     */
+    struct Counts {
+        unsigned int issued;
+        unsigned int avoided;
+        unsigned int restored;
+    } _current, _previous;
+};
+
+#endif // OVRGLSTATE_H
@@ -0,0 +1,272 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "OVRJobSystem.h"
+#include <cassert>
+#include <chrono>
+
+
+/**
+ * The job system that owns the calling thread, if any, and the thread's queue index.
+ */
+static thread_local const OVRJobSystem* CURRENT_JOB_SYSTEM = nullptr;
+static thread_local unsigned int CURRENT_QUEUE_INDEX = 0;
+
+
+/**
+ * Returns the current time in seconds.
+ */
+static double
+getTimeInSeconds() {
+    using namespace std::chrono;
+    return duration_cast<duration<double>>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+OVRJobSystem::Job::Job(const char* const name, std::function<void()> function) :
+_function(std::move(function)),
+_pendingDependencyCount(1),
+_finished(false),
+_dependentsClosed(false),
+_timing({name, 0, 0.0, 0.0}) {}
+
+
+OVRJobSystem::OVRJobSystem(const unsigned int threadCount) :
+_pendingJobCount(0),
+_queuedJobCount(0),
+_running(true) {
+    const auto& hardwareThreadCount = std::thread::hardware_concurrency();
+    const auto& workerCount = threadCount > 0 ? threadCount : std::max(hardwareThreadCount, 2u) - 1;
+
+    // The first queue is shared by threads that are not workers.
+    for (unsigned int i = 0; i <= workerCount; ++i) {
+        _queues.emplace_back(new OVRJobSystem::Queue);
+    }
+    for (unsigned int i = 1; i <= workerCount; ++i) {
+        _workers.emplace_back(&OVRJobSystem::work, this, i);
+    }
+}
+
+
+OVRJobSystem::~OVRJobSystem() {
+    // Finish all pending jobs before stopping the workers.
+    while (_pendingJobCount > 0) {
+        Job* const job = dequeue(0);
+        if (job != nullptr)
+            execute(job, 0);
+        else
+            std::this_thread::yield();
+    }
+    {
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+        _running = false;
+    }
+    _wakeCondition.notify_all();
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+
+unsigned int
+OVRJobSystem::getThreadCount() const {
+    return static_cast<unsigned int>(_workers.size());
+}
+
+
+OVRJobSystem::Job*
+OVRJobSystem::createJob(const char* const name, std::function<void()> function) {
+    std::lock_guard<std::mutex> lock(_allocationMutex);
+    _jobs.emplace_back(name, std::move(function));
+    return &_jobs.back();
+}
+
+
+void
+OVRJobSystem::addDependency(Job* const job, Job* const dependency) {
+    assert(job != nullptr && dependency != nullptr && job != dependency);
+
+    // If the dependency is already finished, there is nothing to wait for.
+    std::lock_guard<std::mutex> lock(dependency->_dependentsMutex);
+    if (!dependency->_dependentsClosed) {
+        ++job->_pendingDependencyCount;
+        dependency->_dependents.push_back(job);
+    }
+}
+
+
+void
+OVRJobSystem::submit(Job* const job) {
+    assert(job != nullptr);
+    ++_pendingJobCount;
+    if (--job->_pendingDependencyCount == 0)
+        enqueue(job);
+}
+
+
+OVRJobSystem::Job*
+OVRJobSystem::run(const char* const name, std::function<void()> function) {
+    Job* const job = createJob(name, std::move(function));
+    submit(job);
+    return job;
+}
+
+
+bool
+OVRJobSystem::isFinished(const Job* const job) const {
+    return job->_finished.load(std::memory_order_acquire);
+}
+
+
+void
+OVRJobSystem::wait(const Job* const job) {
+    const auto& index = getQueueIndex();
+    while (!isFinished(job)) {
+        Job* const next = dequeue(index);
+        if (next != nullptr)
+            execute(next, index);
+        else
+            std::this_thread::yield();
+    }
+}
+
+
+void
+OVRJobSystem::beginFrame() {
+    const auto& index = getQueueIndex();
+    while (_pendingJobCount > 0) {
+        Job* const job = dequeue(index);
+        if (job != nullptr)
+            execute(job, index);
+        else
+            std::this_thread::yield();
+    }
+
+    // Keep the timings of the finished jobs before recycling them.
+    std::lock_guard<std::mutex> lock(_allocationMutex);
+    _timings.clear();
+    for (const auto& job : _jobs) {
+        if (job._finished)
+            _timings.append(job._timing);
+    }
+    _jobs.clear();
+}
+
+
+const QVector<OVRJobSystem::Timing>&
+OVRJobSystem::getTimings() const {
+    return _timings;
+}
+
+
+void
+OVRJobSystem::work(const unsigned int index) {
+    CURRENT_JOB_SYSTEM = this;
+    CURRENT_QUEUE_INDEX = index;
+
+    while (_running) {
+        Job* const job = dequeue(index);
+        if (job != nullptr) {
+            execute(job, index);
+        } else {
+            std::unique_lock<std::mutex> lock(_wakeMutex);
+            _wakeCondition.wait(lock, [this]() { return !_running || _queuedJobCount > 0; });
+        }
+    }
+}
+
+
+void
+OVRJobSystem::enqueue(Job* const job) {
+    auto& queue = *_queues[getQueueIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(job);
+    }
+    ++_queuedJobCount;
+
+    // Acquiring the mutex guarantees that a worker is either waiting, and will be notified,
+    // or has yet to test the queued job count.
+    { std::lock_guard<std::mutex> lock(_wakeMutex); }
+    _wakeCondition.notify_one();
+}
+
+
+OVRJobSystem::Job*
+OVRJobSystem::dequeue(const unsigned int index) {
+    // Pop the most recent job from the thread's own queue.
+    {
+        auto& queue = *_queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            Job* const job = queue.jobs.back();
+            queue.jobs.pop_back();
+            --_queuedJobCount;
+            return job;
+        }
+    }
+    // Steal the oldest job from another thread's queue.
+    const auto& count = static_cast<unsigned int>(_queues.size());
+    for (unsigned int i = 1; i < count; ++i) {
+        auto& queue = *_queues[(index + i) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            Job* const job = queue.jobs.front();
+            queue.jobs.pop_front();
+            --_queuedJobCount;
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+
+void
+OVRJobSystem::execute(Job* const job, const unsigned int index) {
+    auto& timing = job->_timing;
+    timing.thread = index;
+    timing.start = getTimeInSeconds();
+    job->_function();
+    timing.end = getTimeInSeconds();
+
+    // Close the list of dependents, mark the job as finished, then schedule the dependents
+    // that were only waiting for this job.
+    std::vector<Job*> dependents;
+    {
+        std::lock_guard<std::mutex> lock(job->_dependentsMutex);
+        job->_dependentsClosed = true;
+        dependents.swap(job->_dependents);
+    }
+    job->_finished.store(true, std::memory_order_release);
+    for (auto* const dependent : dependents) {
+        if (--dependent->_pendingDependencyCount == 0)
+            enqueue(dependent);
+    }
+    --_pendingJobCount;
+}
+
+
+unsigned int
+OVRJobSystem::getQueueIndex() const {
+    return CURRENT_JOB_SYSTEM == this ? CURRENT_QUEUE_INDEX : 0;
+}
@@ -0,0 +1,240 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef OVRJOBSYSTEM_H
+#define OVRJOBSYSTEM_H
+
+#include <QVector>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * @brief A work-stealing job system.
+ *
+ * Each worker thread owns a queue of jobs that is processed in last-in first-out order.
+ * A worker whose queue is empty steals the oldest job from another thread's queue. Jobs
+ * submitted from a thread that is not a worker (e.g. the rendering thread) are pushed
+ * onto a shared queue, which that thread also processes while it waits on a job.
+ *
+ * Jobs are allocated per frame: all jobs created during a frame remain valid until the
+ * next call to beginFrame, which waits for them to finish before recycling them.
+ */
+class OVRJobSystem {
+public:
+    /**
+     * @struct Timing
+     * @brief The time (in seconds) at which a job started and finished, and the index
+     * of the thread that executed it.
+     */
+    struct Timing {
+        const char* name;
+        unsigned int thread;
+        double start;
+        double end;
+    };
+    /**
+     * @brief A unit of work.
+     *
+     * A job is created with createJob, made dependent on other jobs with addDependency,
+     * then scheduled with submit. A job only starts once all its dependencies are finished.
+     */
+    class Job {
+        friend class OVRJobSystem;
+    public:
+        Job(const char* const name, std::function<void()> function);
+    private:
+        /**
+         * The job's function.
+         */
+        std::function<void()> _function;
+        /**
+         * The number of unfinished dependencies, plus one until the job is submitted.
+         */
+        std::atomic<unsigned int> _pendingDependencyCount;
+        /**
+         * This flag is set once the job's function has returned.
+         */
+        std::atomic<bool> _finished;
+        /**
+         * The jobs that depend on this one. The list is closed once the job is finished.
+         */
+        std::mutex _dependentsMutex;
+        std::vector<Job*> _dependents;
+        bool _dependentsClosed;
+        /**
+         * The job's name and timing.
+         */
+        OVRJobSystem::Timing _timing;
+    };
+    /**
+     * @brief Instantiate a job system with the specified number of worker threads.
+     *
+     * @param threadCount the number of worker threads. If zero, one worker is created for
+     * each hardware thread, save for one that is left to the thread that submits jobs.
+     */
+    explicit OVRJobSystem(const unsigned int threadCount = 0);
+    /**
+     * @brief The destructor. All pending jobs are finished before the workers are stopped.
+     */
+    ~OVRJobSystem();
+    /**
+     * Return the number of worker threads.
+     */
+    unsigned int getThreadCount() const;
+    /**
+     * @brief Create a job that will call the specified function once it is submitted and
+     * its dependencies are finished.
+     *
+     * @param name the job's name, used for profiling. The string must outlive the frame.
+     * @param function the job's function.
+     */
+    Job* createJob(const char* const name, std::function<void()> function);
+    /**
+     * @brief Make a job depend on another, i.e. the job will not start before its dependency
+     * is finished. This must be called before the job is submitted.
+     *
+     * @param job the dependent job.
+     * @param dependency the job that must finish first.
+     */
+    void addDependency(Job* const job, Job* const dependency);
+    /**
+     * @brief Schedule a job for execution. The job starts as soon as its dependencies are
+     * finished and a thread is available.
+     *
+     * @param job the job to schedule.
+     */
+    void submit(Job* const job);
+    /**
+     * @brief Create and submit a job.
+     *
+     * @param name the job's name.
+     * @param function the job's function.
+     */
+    Job* run(const char* const name, std::function<void()> function);
+    /**
+     * Returns true if the specified job is finished, false otherwise. This function
+     * is wait-free.
+     * @param job the job to query.
+     */
+    bool isFinished(const Job* const job) const;
+    /**
+     * @brief Wait for a job to finish.
+     *
+     * Rather than blocking, the calling thread executes pending jobs until the specified
+     * job is finished.
+     * @param job the job to wait for.
+     */
+    void wait(const Job* const job);
+    /**
+     * @brief Begin a new frame.
+     *
+     * This waits for all of the current frame's jobs to finish, records their timings,
+     * then recycles them. Jobs created during the previous frame must not be used after
+     * this function is called.
+     */
+    void beginFrame();
+    /**
+     * Return the timings of the jobs that were executed during the previous frame.
+     */
+    const QVector<OVRJobSystem::Timing>& getTimings() const;
+private:
+    /**
+     * A thread's queue of jobs that are ready to be executed.
+     */
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Job*> jobs;
+    };
+    /**
+     * The function executed by each worker thread.
+     * @param index the worker's queue index.
+     */
+    void work(const unsigned int index);
+    /**
+     * Push a job that is ready to be executed onto the calling thread's queue.
+     * @param job the job to push.
+     */
+    void enqueue(Job* const job);
+    /**
+     * Pop a job from the specified thread's queue or, if it is empty, steal one from
+     * another thread's queue. Returns nullptr if there is no job to execute.
+     * @param index the calling thread's queue index.
+     */
+    Job* dequeue(const unsigned int index);
+    /**
+     * Execute a job, then schedule the jobs that depend on it.
+     * @param job the job to execute.
+     * @param index the calling thread's queue index.
+     */
+    void execute(Job* const job, const unsigned int index);
+    /**
+     * Return the calling thread's queue index.
+     */
+    unsigned int getQueueIndex() const;
+    /**
+     * The queues. The first queue is shared by all threads that are not workers.
+     */
+    std::vector<std::unique_ptr<OVRJobSystem::Queue>> _queues;
+    /**
+     * The worker threads.
+     */
+    std::vector<std::thread> _workers;
+    /**
+     * The jobs created during the current frame. A deque is used so that jobs are never moved.
+     */
+    std::deque<Job> _jobs;
+    /**
+     * The mutex that protects the allocation of jobs.
+     */
+    std::mutex _allocationMutex;
+    /**
+     * The number of jobs that have been submitted but not finished.
+     */
+    std::atomic<unsigned int> _pendingJobCount;
+    /**
+     * The number of jobs waiting in the queues.
+     */
+    std::atomic<unsigned int> _queuedJobCount;
+    /**
+     * Idle workers sleep on this condition variable until a job is queued.
+     */
+    std::condition_variable _wakeCondition;
+    std::mutex _wakeMutex;
+    /**
+     * False when the workers need to stop.
+     */
+    std::atomic<bool> _running;
+    /**
+     * The timings of the jobs executed during the previous frame.
+     */
+    QVector<OVRJobSystem::Timing> _timings;
+};
+
+#endif // OVRJOBSYSTEM_H
@@ -0,0 +1,286 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "OVROcclusionCuller.h"
+#include <QOpenGLContext>
+#include <QOpenGLShaderProgram>
+#include <cassert>
+
+
+/**
+ * The unit cube's corners and triangles. The bounds are drawn by scaling and translating
+ * the cube in the vertex shader.
+ */
+static const GLfloat CUBE_VERTICES[] = {
+    0.0f, 0.0f, 0.0f,
+    1.0f, 0.0f, 0.0f,
+    0.0f, 1.0f, 0.0f,
+    1.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 1.0f,
+    1.0f, 0.0f, 1.0f,
+    0.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f,
+};
+static const GLushort CUBE_INDICES[] = {
+    0, 2, 1, 1, 2, 3,
+    4, 5, 6, 5, 7, 6,
+    0, 1, 4, 1, 5, 4,
+    2, 6, 3, 3, 6, 7,
+    0, 4, 2, 2, 4, 6,
+    1, 3, 5, 3, 7, 5,
+};
+
+
+constexpr unsigned int OVROcclusionCuller::QueryCount;
+
+
+OVROcclusionCuller::OVROcclusionCuller() :
+_enabled(false),
+_frame(0),
+_program(nullptr),
+_vertexArray(0),
+_vbo(0),
+_ibo(0) {}
+
+
+OVROcclusionCuller::~OVROcclusionCuller() {
+    release();
+}
+
+
+void
+OVROcclusionCuller::release() {
+    for (auto& object : _objects) {
+        if (object.queries[0] != 0) {
+            assert(QOpenGLContext::currentContext() != nullptr);
+            glDeleteQueries(static_cast<GLsizei>(object.queries.size()), object.queries.data());
+            object.queries.fill(0);
+            object.pending.fill(false);
+        }
+    }
+    if (_vbo != 0) {
+        assert(QOpenGLContext::currentContext() != nullptr);
+        glDeleteVertexArrays(1, &_vertexArray);
+        glDeleteBuffers(1, &_vbo);
+        glDeleteBuffers(1, &_ibo);
+        _vertexArray = 0;
+        _vbo = 0;
+        _ibo = 0;
+    }
+    _program.reset();
+}
+
+
+bool
+OVROcclusionCuller::isEnabled() const {
+    return _enabled;
+}
+
+
+void
+OVROcclusionCuller::setEnabled(const bool enable) {
+    // Results that are still pending are discarded, so that stale results are not
+    // applied if occlusion culling is enabled again.
+    _enabled = enable;
+    for (auto& object : _objects) {
+        object.visible = true;
+        object.pending.fill(false);
+    }
+}
+
+
+unsigned int
+OVROcclusionCuller::addObject(const QVector3D& minimum, const QVector3D& maximum) {
+    unsigned int object = 0;
+    if (_unregistered.empty()) {
+        object = static_cast<unsigned int>(_objects.size());
+        _objects.push_back({false, {}, {}, false, {}, {}, {}, 0});
+    } else {
+        object = _unregistered.back();
+        _unregistered.pop_back();
+    }
+    auto& o = _objects[object];
+    o.registered = true;
+    o.visible = true;
+    o.pending.fill(false);
+    o.collected = _frame;
+    setBounds(object, minimum, maximum);
+    return object;
+}
+
+
+void
+OVROcclusionCuller::setBounds(const unsigned int object, const QVector3D& minimum, const QVector3D& maximum) {
+    assert(object < _objects.size() && _objects[object].registered);
+    _objects[object].minimum = minimum;
+    _objects[object].maximum = maximum;
+}
+
+
+void
+OVROcclusionCuller::removeObject(const unsigned int object) {
+    assert(object < _objects.size() && _objects[object].registered);
+    _objects[object].registered = false;
+    _unregistered.push_back(object);
+}
+
+
+bool
+OVROcclusionCuller::isVisible(const unsigned int object) const {
+    assert(object < _objects.size() && _objects[object].registered);
+    return _objects[object].visible;
+}
+
+
+unsigned int
+OVROcclusionCuller::getOccludedObjectCount() const {
+    unsigned int count = 0;
+    for (const auto& object : _objects) {
+        if (object.registered && !object.visible)
+            ++count;
+    }
+    return count;
+}
+
+
+void
+OVROcclusionCuller::beginFrame() {
+    ++_frame;
+    if (!_enabled)
+        return;
+
+    // Only the queries whose results are available are collected so the CPU never waits.
+    // If several results are available, the most recent one prevails.
+    for (auto& object : _objects) {
+        if (!object.registered)
+            continue;
+
+        for (unsigned int i = 0; i < QueryCount; ++i) {
+            if (!object.pending[i])
+                continue;
+
+            GLint available = GL_FALSE;
+            glGetQueryObjectiv(object.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint passed = GL_FALSE;
+                glGetQueryObjectuiv(object.queries[i], GL_QUERY_RESULT, &passed);
+                if (object.frames[i] > object.collected) {
+                    object.visible = passed != GL_FALSE;
+                    object.collected = object.frames[i];
+                }
+                object.pending[i] = false;
+            }
+        }
+    }
+}
+
+
+void
+OVROcclusionCuller::issueQueries(OVRGLState& state, const QMatrix4x4& transform, const QVector3D& eye, const float margin) {
+    if (!_enabled || _objects.empty())
+        return;
+
+    initialize(state);
+
+    // The bounds are tested against the depth buffer without writing to any buffer. The
+    // color mask is not tracked, so it is saved and restored here.
+    GLboolean colorMask[4] = {GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE};
+    glGetBooleanv(GL_COLOR_WRITEMASK, colorMask);
+    state.useProgram(_program->programId());
+    state.bindVertexArray(_vertexArray);
+    state.setCapability(GL_DEPTH_TEST, true);
+    state.setCapability(GL_CULL_FACE, false);
+    state.setCapability(GL_BLEND, false);
+    state.setDepthMask(false);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    _program->setUniformValue("transform", transform);
+
+    const QVector3D dilation(margin, margin, margin);
+    const auto& slot = _frame % QueryCount;
+    for (auto& object : _objects) {
+        if (!object.registered || object.pending[slot])
+            continue;
+
+        const auto& minimum = object.minimum - dilation;
+        const auto& maximum = object.maximum + dilation;
+        if (eye.x() >= minimum.x() && eye.y() >= minimum.y() && eye.z() >= minimum.z() &&
+            eye.x() <= maximum.x() && eye.y() <= maximum.y() && eye.z() <= maximum.z()) {
+            object.visible = true;
+            object.collected = _frame;
+            continue;
+        }
+        if (object.queries[0] == 0)
+            glGenQueries(static_cast<GLsizei>(object.queries.size()), object.queries.data());
+
+        _program->setUniformValue("minimum", minimum);
+        _program->setUniformValue("maximum", maximum);
+        glBeginQuery(GL_ANY_SAMPLES_PASSED, object.queries[slot]);
+        glDrawElements(GL_TRIANGLES, sizeof(CUBE_INDICES) / sizeof(CUBE_INDICES[0]), GL_UNSIGNED_SHORT, nullptr);
+        glEndQuery(GL_ANY_SAMPLES_PASSED);
+        object.pending[slot] = true;
+        object.frames[slot] = _frame;
+    }
+    glColorMask(colorMask[0], colorMask[1], colorMask[2], colorMask[3]);
+}
+
+
+void
+OVROcclusionCuller::initialize(OVRGLState& state) {
+    if (_program)
+        return;
+
+    static const char* const VERTEX_SHADER =
+        "#version 120\n"
+        "attribute vec3 position;\n"
+        "uniform mat4 transform;\n"
+        "uniform vec3 minimum;\n"
+        "uniform vec3 maximum;\n"
+        "void main() {\n"
+        "    gl_Position = transform * vec4(mix(minimum, maximum, position), 1.0);\n"
+        "}\n";
+    static const char* const FRAGMENT_SHADER =
+        "#version 120\n"
+        "void main() {\n"
+        "    gl_FragColor = vec4(1.0);\n"
+        "}\n";
+    _program.reset(new QOpenGLShaderProgram);
+    _program->addShaderFromSourceCode(QOpenGLShader::Vertex, VERTEX_SHADER);
+    _program->addShaderFromSourceCode(QOpenGLShader::Fragment, FRAGMENT_SHADER);
+    _program->bindAttributeLocation("position", 0);
+    const auto result = _program->link();
+    assert(result);
+
+    // The cube is drawn with the culler's own vertex array, which holds the element
+    // buffer binding and the vertex attribute, so the application's are left untouched.
+    glGenVertexArrays(1, &_vertexArray);
+    glGenBuffers(1, &_vbo);
+    glGenBuffers(1, &_ibo);
+    assert(_vertexArray != 0 && _vbo != 0 && _ibo != 0);
+    state.bindVertexArray(_vertexArray);
+    state.bindBuffer(GL_ARRAY_BUFFER, _vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(CUBE_VERTICES), CUBE_VERTICES, GL_STATIC_DRAW);
+    state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(CUBE_INDICES), CUBE_INDICES, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+}
@@ -0,0 +1,188 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef OVROCCLUSIONCULLER_H
+#define OVROCCLUSIONCULLER_H
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES
+#endif
+
+#include "OVRGLState.h"
+#include <QMatrix4x4>
+#include <QVector3D>
+#include <array>
+#include <memory>
+#include <vector>
+
+
+class QOpenGLShaderProgram;
+
+/**
+ * @brief A service that culls objects hidden behind the scene's occluders.
+ *
+ * Objects are registered with their axis-aligned bounds, in the coordinate system that
+ * RenderTransforms::view transforms. Once the first eye in the device's render order has
+ * been painted, the bounds of each object are drawn against that eye's depth buffer, without
+ * writing to it, inside an asynchronous occlusion query. Both eyes see nearly the same
+ * visible set, so the results are reused for the second eye: the bounds are dilated by a
+ * margin derived from the distance between the eyes (see ovrEyeRenderDesc::ViewAdjust),
+ * which covers the parallax between the eyes' viewpoints.
+ *
+ * The results are collected at the start of each frame, but only if they are available,
+ * so the CPU never waits for the GPU. Each object is therefore culled with the result
+ * of the most recent query that completed, usually from the previous frame, and an
+ * object that is disoccluded only reappears once its query has completed. Objects
+ * with no result yet are visible.
+ */
+class OVROcclusionCuller {
+public:
+    /**
+     * Instantiate a disabled occlusion culler.
+     */
+    OVROcclusionCuller();
+    /**
+     * @brief The destructor. The OpenGL resources must have been released (see release)
+     * unless the rendering context is still current.
+     */
+    ~OVROcclusionCuller();
+    /**
+     * @brief Delete the queries, the vertex array, the buffers and the program, which
+     * requires the rendering context to be current. They are created again when queries
+     * are next issued.
+     */
+    void release();
+    /**
+     * Returns true if occlusion culling is enabled, false otherwise.
+     */
+    bool isEnabled() const;
+    /**
+     * @brief Enable or disable occlusion culling. While occlusion culling is disabled,
+     * every object is visible and no queries are issued.
+     *
+     * @param enable true to enable occlusion culling, false to disable it.
+     */
+    void setEnabled(const bool enable);
+    /**
+     * @brief Register an object and return its identifier. The object is visible until
+     * a query determines otherwise.
+     *
+     * @param minimum the minimum corner of the object's bounds.
+     * @param maximum the maximum corner of the object's bounds.
+     */
+    unsigned int addObject(const QVector3D& minimum, const QVector3D& maximum);
+    /**
+     * @brief Update an object's bounds, e.g. when the object moves.
+     *
+     * @param object the object's identifier.
+     * @param minimum the minimum corner of the object's bounds.
+     * @param maximum the maximum corner of the object's bounds.
+     */
+    void setBounds(const unsigned int object, const QVector3D& minimum, const QVector3D& maximum);
+    /**
+     * @brief Unregister an object. Its identifier may be returned by a later call to addObject.
+     *
+     * @param object the object's identifier.
+     */
+    void removeObject(const unsigned int object);
+    /**
+     * @brief Returns true if an object may be visible from either eye, false if it is
+     * occluded and need not be drawn.
+     *
+     * @param object the object's identifier.
+     */
+    bool isVisible(const unsigned int object) const;
+    /**
+     * Return the number of registered objects that are occluded.
+     */
+    unsigned int getOccludedObjectCount() const;
+    /**
+     * @brief Begin a new frame.
+     *
+     * This collects the results of the queries that are available, and must be called on
+     * the rendering thread while the rendering context is current.
+     */
+    void beginFrame();
+    /**
+     * @brief Issue an occlusion query for each object whose previous queries are not all
+     * pending. This must be called once the scene has been drawn from the first eye's
+     * viewpoint, while the eye's framebuffer and viewport are bound, and within a state
+     * scope (see OVRGLState::Scope), since the culler binds its own vertex array.
+     *
+     * An object whose dilated bounds contain the eye is visible and is not queried, since
+     * its bounds would be clipped by the near clipping plane.
+     * @param state the state tracker through which the state is changed.
+     * @param transform the eye's view-projection matrix.
+     * @param eye the eye's position.
+     * @param margin the distance by which the bounds are dilated.
+     */
+    void issueQueries(OVRGLState& state, const QMatrix4x4& transform, const QVector3D& eye, const float margin);
+private:
+    /**
+     * The number of queries per object, i.e. the number of frames a query may remain
+     * pending before an object is no longer queried.
+     */
+    static constexpr unsigned int QueryCount = 3;
+    /**
+     * An object, its bounds and visibility, its queries and the frame each was issued
+     * in, and the frame of the most recent query whose result was collected.
+     */
+    struct Object {
+        bool registered;
+        QVector3D minimum;
+        QVector3D maximum;
+        bool visible;
+        std::array<GLuint, QueryCount> queries;
+        std::array<bool, QueryCount> pending;
+        std::array<unsigned long long, QueryCount> frames;
+        unsigned long long collected;
+    };
+    /**
+     * Create the program, the vertex array and the buffers used to draw the bounds, if
+     * need be.
+     * @param state the state tracker through which the state is changed.
+     */
+    void initialize(OVRGLState& state);
+    /**
+     * This flag is set if occlusion culling is enabled.
+     */
+    bool _enabled;
+    /**
+     * The objects, and the identifiers of the objects that were unregistered.
+     */
+    std::vector<OVROcclusionCuller::Object> _objects;
+    std::vector<unsigned int> _unregistered;
+    /**
+     * The current frame's index.
+     */
+    unsigned long long _frame;
+    /**
+     * The program used to draw the bounds, the vertex array that the unit cube is drawn
+     * with, and the cube's vertex and index buffers.
+     */
+    std::unique_ptr<QOpenGLShaderProgram> _program;
+    GLuint _vertexArray;
+    GLuint _vbo;
+    GLuint _ibo;
+};
+
+#endif // OVROCCLUSIONCULLER_H
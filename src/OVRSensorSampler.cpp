@@ -0,0 +1,219 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "OVRSensorSampler.h"
+#include <chrono>
+#include <cmath>
+
+
+/**
+ * Returns the normalized linear interpolation of two orientations, along the shortest arc.
+ * @param a the first orientation.
+ * @param b the second orientation.
+ * @param t the interpolation factor.
+ */
+static ovrQuatf
+nlerp(const ovrQuatf& a, const ovrQuatf& b, const float t) {
+    const auto& sign = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0.0f ? -1.0f : 1.0f;
+    ovrQuatf q = {
+        a.x + t * (sign * b.x - a.x),
+        a.y + t * (sign * b.y - a.y),
+        a.z + t * (sign * b.z - a.z),
+        a.w + t * (sign * b.w - a.w),
+    };
+    const auto& length = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+    q.x /= length;
+    q.y /= length;
+    q.z /= length;
+    q.w /= length;
+    return q;
+}
+
+
+/**
+ * Returns the linear interpolation of two vectors.
+ * @param a the first vector.
+ * @param b the second vector.
+ * @param t the interpolation factor.
+ */
+static ovrVector3f
+lerp(const ovrVector3f& a, const ovrVector3f& b, const float t) {
+    return {a.x + t * (b.x - a.x), a.y + t * (b.y - a.y), a.z + t * (b.z - a.z)};
+}
+
+
+/**
+ * Returns the pose reached after the specified time, starting from a sample and assuming
+ * its velocities are constant. Like the SDK's own prediction, the angular velocity is
+ * expressed in the head's frame of reference.
+ * @param sample the sample to extrapolate.
+ * @param dt the time elapsed since the sample.
+ */
+static ovrPosef
+predict(const OVRSensorSampler::Sample& sample, const float dt) {
+    ovrPosef pose = sample.pose;
+    const auto& v = sample.linearVelocity;
+    pose.Position = {pose.Position.x + dt * v.x, pose.Position.y + dt * v.y, pose.Position.z + dt * v.z};
+
+    const auto& w = sample.angularVelocity;
+    const auto& speed = std::sqrt(w.x * w.x + w.y * w.y + w.z * w.z);
+    if (speed > 0.0f) {
+        // Rotate the orientation by the angle covered around the angular velocity's axis.
+        const auto& s = std::sin(0.5f * speed * dt) / speed;
+        const ovrQuatf r = {s * w.x, s * w.y, s * w.z, std::cos(0.5f * speed * dt)};
+        const auto& q = sample.pose.Orientation;
+        pose.Orientation = {
+            q.w * r.x + q.x * r.w + q.y * r.z - q.z * r.y,
+            q.w * r.y - q.x * r.z + q.y * r.w + q.z * r.x,
+            q.w * r.z + q.x * r.y - q.y * r.x + q.z * r.w,
+            q.w * r.w - q.x * r.x - q.y * r.y - q.z * r.z,
+        };
+    }
+    return pose;
+}
+
+
+constexpr unsigned int OVRSensorSampler::Capacity;
+
+
+OVRSensorSampler::OVRSensorSampler(ovrHmd hmd) :
+_hmd(hmd),
+_count(0),
+_running(false) {
+    for (auto& slot : _ring) {
+        slot.sequence = 0;
+    }
+}
+
+
+OVRSensorSampler::~OVRSensorSampler() {
+    stop();
+}
+
+
+void
+OVRSensorSampler::start(const double rate) {
+    stop();
+    _running = true;
+    _thread = std::thread(&OVRSensorSampler::sample, this, rate);
+}
+
+
+void
+OVRSensorSampler::stop() {
+    if (_running) {
+        _running = false;
+        _thread.join();
+    }
+}
+
+
+bool
+OVRSensorSampler::isRunning() const {
+    return _running;
+}
+
+
+bool
+OVRSensorSampler::getLatestSample(OVRSensorSampler::Sample& sample) const {
+    // If the most recent slot is overwritten while it is read, read the new most recent one.
+    while (true) {
+        const auto& count = _count.load(std::memory_order_acquire);
+        if (count == 0)
+            return false;
+        if (read(count - 1, sample))
+            return true;
+    }
+}
+
+
+bool
+OVRSensorSampler::getPose(const double time, ovrPosef& pose) const {
+    Sample next;
+    if (!getLatestSample(next))
+        return false;
+    if (time >= next.time) {
+        pose = predict(next, static_cast<float>(time - next.time));
+        return true;
+    }
+
+    // Walk back from the most recent sample until the time is bracketed.
+    const auto& count = _count.load(std::memory_order_acquire);
+    const auto& oldest = count > Capacity ? count - Capacity : 0;
+    for (auto index = count - 1; index > oldest; --index) {
+        Sample previous;
+        if (!read(index - 1, previous))
+            return false;
+        if (previous.time <= time) {
+            const auto& t = static_cast<float>((time - previous.time) / (next.time - previous.time));
+            pose.Orientation = nlerp(previous.pose.Orientation, next.pose.Orientation, t);
+            pose.Position = lerp(previous.pose.Position, next.pose.Position, t);
+            return true;
+        }
+        next = previous;
+    }
+    return false;
+}
+
+
+bool
+OVRSensorSampler::read(const unsigned long long index, OVRSensorSampler::Sample& sample) const {
+    // A slot's sequence number is incremented twice each time it is written, so the
+    // number expected for the requested sample is derived from its index.
+    const auto& slot = _ring[index % Capacity];
+    const auto& expected = static_cast<unsigned int>(2 * (index / Capacity + 1));
+    if (slot.sequence.load(std::memory_order_acquire) != expected)
+        return false;
+
+    sample = slot.sample;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == expected;
+}
+
+
+void
+OVRSensorSampler::sample(const double rate) {
+    using namespace std::chrono;
+    const auto& period = duration_cast<steady_clock::duration>(duration<double>(1.0 / rate));
+    auto next = steady_clock::now();
+    double lastTime = 0.0;
+    while (_running) {
+        // Only new sensor readings are recorded.
+        const auto& state = ovrHmd_GetSensorState(_hmd, ovr_GetTimeInSeconds());
+        const auto& recorded = state.Recorded;
+        if ((state.StatusFlags & ovrStatus_OrientationTracked) && recorded.TimeInSeconds > lastTime) {
+            lastTime = recorded.TimeInSeconds;
+
+            const auto& index = _count.load(std::memory_order_relaxed);
+            auto& slot = _ring[index % Capacity];
+            const auto& sequence = slot.sequence.load(std::memory_order_relaxed);
+            slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.sample = {recorded.TimeInSeconds, recorded.Pose, recorded.AngularVelocity, recorded.LinearVelocity};
+            slot.sequence.store(sequence + 2, std::memory_order_release);
+            _count.store(index + 1, std::memory_order_release);
+        }
+        next += period;
+        std::this_thread::sleep_until(next);
+    }
+}
@@ -0,0 +1,139 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef OVRSENSORSAMPLER_H
+#define OVRSENSORSAMPLER_H
+
+#include <OVR_CAPI.h>
+#include <array>
+#include <atomic>
+#include <thread>
+
+
+/**
+ * @brief A thread that samples the head tracking sensor at a fixed rate.
+ *
+ * Samples are written to a ring buffer in which each slot is protected by a sequence
+ * lock: the sampler never waits for readers, and readers never wait for the sampler.
+ * A read only fails, and the most recent sample is read again, in the unlikely event
+ * that the slot being read is overwritten. Poses can therefore be queried from
+ * any thread (e.g. game logic, audio or networking) at the sensor's rate rather than at
+ * the frame rate, without taking a lock.
+ */
+class OVRSensorSampler {
+public:
+    /**
+     * @struct Sample
+     * @brief The sensor's state at a given time (in seconds).
+     */
+    struct Sample {
+        double time;
+        ovrPosef pose;
+        ovrVector3f angularVelocity;
+        ovrVector3f linearVelocity;
+    };
+    /**
+     * The number of samples kept in the ring buffer.
+     */
+    static constexpr unsigned int Capacity = 256;
+    /**
+     * @brief Instantiate a sampler for the specified device. The sampler is stopped.
+     *
+     * @param hmd the device whose sensor is sampled.
+     */
+    explicit OVRSensorSampler(ovrHmd hmd);
+    /**
+     * The destructor. The sampling thread is stopped.
+     */
+    ~OVRSensorSampler();
+    /**
+     * @brief Start sampling the sensor at the specified rate. If the sampler is already
+     * running, it is restarted at the new rate.
+     *
+     * Note that the sensor must have been started by the OVRWindow (see the tracking
+     * features) for samples to be recorded.
+     * @param rate the sampling rate in Hz.
+     */
+    void start(const double rate = 1000.0);
+    /**
+     * Stop sampling the sensor.
+     */
+    void stop();
+    /**
+     * Returns true if the sensor is being sampled, false otherwise.
+     */
+    bool isRunning() const;
+    /**
+     * @brief Return the most recent sample. Returns false if no sample has been recorded.
+     *
+     * @param sample the sample to write to.
+     */
+    bool getLatestSample(OVRSensorSampler::Sample& sample) const;
+    /**
+     * @brief Return the head pose at the specified time. Returns false if no sample has
+     * been recorded, or if the time precedes the oldest sample in the ring buffer.
+     *
+     * If the time falls between two samples, the pose is interpolated. If it follows the
+     * most recent sample, the pose is predicted from the sample's velocities.
+     * @param time the time (in seconds, see ovr_GetTimeInSeconds) at which the pose is queried.
+     * @param pose the pose to write to.
+     */
+    bool getPose(const double time, ovrPosef& pose) const;
+private:
+    /**
+     * A slot in the ring buffer. The sequence number is odd while the slot is written, and
+     * is incremented twice per write.
+     */
+    struct Slot {
+        std::atomic<unsigned int> sequence;
+        OVRSensorSampler::Sample sample;
+    };
+    /**
+     * Read the sample stored in the slot at the specified index. Returns false if the
+     * slot was overwritten by a newer sample.
+     * @param index the sample's index, i.e. the number of samples recorded before it.
+     * @param sample the sample to write to.
+     */
+    bool read(const unsigned long long index, OVRSensorSampler::Sample& sample) const;
+    /**
+     * The function executed by the sampling thread.
+     * @param rate the sampling rate in Hz.
+     */
+    void sample(const double rate);
+    /**
+     * The device whose sensor is sampled.
+     */
+    const ovrHmd _hmd;
+    /**
+     * The ring buffer and the number of samples that have been written to it.
+     */
+    std::array<OVRSensorSampler::Slot, Capacity> _ring;
+    std::atomic<unsigned long long> _count;
+    /**
+     * The sampling thread, and the flag that keeps it running.
+     */
+    std::thread _thread;
+    std::atomic<bool> _running;
+};
+
+#endif // OVRSENSORSAMPLER_H
@@ -0,0 +1,253 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "OVRTracer.h"
+#include <cassert>
+#include <chrono>
+
+
+/**
+ * The tracer that owns the calling thread's buffer, if any, and the buffer.
+ */
+static thread_local const OVRTracer* CURRENT_TRACER = nullptr;
+static thread_local void* CURRENT_BUFFER = nullptr;
+
+
+/**
+ * The interval (in milliseconds) at which the writer drains the buffers.
+ */
+static constexpr int WRITE_INTERVAL = 10;
+
+
+/**
+ * Writes a string as a quoted JSON string, i.e. with its quotes, backslashes and control
+ * characters escaped.
+ * @param file the file to write to.
+ * @param string the string to write.
+ */
+static void
+writeJSONString(std::FILE* const file, const char* const string) {
+    std::fputc('"', file);
+    for (const char* c = string; *c != '\0'; ++c) {
+        const auto& character = static_cast<unsigned char>(*c);
+        if (character == '"' || character == '\\') {
+            std::fputc('\\', file);
+            std::fputc(character, file);
+        } else if (character < 0x20) {
+            std::fprintf(file, "\\u%04x", character);
+        } else {
+            std::fputc(character, file);
+        }
+    }
+    std::fputc('"', file);
+}
+
+
+constexpr std::size_t OVRTracer::Buffer::CAPACITY;
+
+
+OVRTracer::Scope::Scope(OVRTracer& tracer, const char* const name) :
+_tracer(tracer),
+_name(name) {
+    _tracer.begin(_name);
+}
+
+
+OVRTracer::Scope::~Scope() {
+    _tracer.end(_name);
+}
+
+
+OVRTracer::OVRTracer() :
+_file(nullptr),
+_startTime(0.0),
+_hasEvents(false),
+_tracing(false),
+_droppedEventCount(0) {}
+
+
+OVRTracer::~OVRTracer() {
+    stop();
+}
+
+
+double
+OVRTracer::getTime() {
+    using namespace std::chrono;
+    return duration_cast<duration<double>>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+bool
+OVRTracer::start(const QString& path) {
+    stop();
+
+    _file = std::fopen(path.toLocal8Bit().constData(), "w");
+    if (_file == nullptr)
+        return false;
+
+    // Discard the events that were recorded after the previous trace was stopped.
+    {
+        std::lock_guard<std::mutex> lock(_buffersMutex);
+        for (auto& buffer : _buffers) {
+            buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_release);
+        }
+    }
+    std::fputs("{\"traceEvents\":[", _file);
+    _hasEvents = false;
+    _startTime = getTime();
+    _droppedEventCount = 0;
+    _tracing.store(true, std::memory_order_release);
+    _writer = std::thread(&OVRTracer::write, this);
+    return true;
+}
+
+
+void
+OVRTracer::stop() {
+    if (!_tracing)
+        return;
+
+    _tracing.store(false, std::memory_order_release);
+    _writer.join();
+    drain();
+    std::fputs("\n],\"displayTimeUnit\":\"ms\"}\n", _file);
+    std::fclose(_file);
+    _file = nullptr;
+}
+
+
+bool
+OVRTracer::isTracing() const {
+    return _tracing.load(std::memory_order_relaxed);
+}
+
+
+unsigned int
+OVRTracer::getDroppedEventCount() const {
+    return _droppedEventCount;
+}
+
+
+void
+OVRTracer::begin(const char* const name) {
+    if (isTracing())
+        record({name, 'B', -1, getTime(), 0.0});
+}
+
+
+void
+OVRTracer::end(const char* const name) {
+    if (isTracing())
+        record({name, 'E', -1, getTime(), 0.0});
+}
+
+
+void
+OVRTracer::complete(const char* const name, const double start, const double duration, const int thread) {
+    if (isTracing())
+        record({name, 'X', thread, start, duration});
+}
+
+
+void
+OVRTracer::instant(const char* const name) {
+    if (isTracing())
+        record({name, 'i', -1, getTime(), 0.0});
+}
+
+
+void
+OVRTracer::counter(const char* const name, const double value) {
+    if (isTracing())
+        record({name, 'C', -1, getTime(), value});
+}
+
+
+void
+OVRTracer::record(const OVRTracer::Event& event) {
+    auto& buffer = getBuffer();
+    const auto& head = buffer.head.load(std::memory_order_relaxed);
+    if (head - buffer.tail.load(std::memory_order_acquire) == Buffer::CAPACITY) {
+        ++_droppedEventCount;
+        return;
+    }
+    auto& slot = buffer.events[head % Buffer::CAPACITY];
+    slot = event;
+    if (slot.thread < 0)
+        slot.thread = buffer.thread;
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+
+OVRTracer::Buffer&
+OVRTracer::getBuffer() {
+    if (CURRENT_TRACER != this) {
+        std::lock_guard<std::mutex> lock(_buffersMutex);
+        _buffers.emplace_back(new OVRTracer::Buffer);
+        auto& buffer = *_buffers.back();
+        buffer.head = 0;
+        buffer.tail = 0;
+        buffer.thread = static_cast<int>(_buffers.size());
+        CURRENT_TRACER = this;
+        CURRENT_BUFFER = &buffer;
+    }
+    return *static_cast<OVRTracer::Buffer*>(CURRENT_BUFFER);
+}
+
+
+void
+OVRTracer::write() {
+    while (_tracing.load(std::memory_order_acquire)) {
+        drain();
+        std::this_thread::sleep_for(std::chrono::milliseconds(WRITE_INTERVAL));
+    }
+}
+
+
+void
+OVRTracer::drain() {
+    std::lock_guard<std::mutex> lock(_buffersMutex);
+    for (auto& buffer : _buffers) {
+        const auto& head = buffer->head.load(std::memory_order_acquire);
+        auto tail = buffer->tail.load(std::memory_order_relaxed);
+        for (; tail != head; ++tail) {
+            // Timestamps and durations are expressed in microseconds.
+            const auto& event = buffer->events[tail % Buffer::CAPACITY];
+            const auto& timestamp = 1e6 * (event.time - _startTime);
+            std::fprintf(_file, "%s\n{\"name\":", _hasEvents ? "," : "");
+            writeJSONString(_file, event.name);
+            std::fprintf(_file, ",\"cat\":\"OVRWindow\",\"ph\":\"%c\",\"pid\":1,\"tid\":%d,\"ts\":%.3f",
+                event.phase, event.thread, timestamp);
+            if (event.phase == 'X')
+                std::fprintf(_file, ",\"dur\":%.3f", 1e6 * event.value);
+            else if (event.phase == 'C')
+                std::fprintf(_file, ",\"args\":{\"value\":%g}", event.value);
+            else if (event.phase == 'i')
+                std::fputs(",\"s\":\"t\"", _file);
+            std::fputc('}', _file);
+            _hasEvents = true;
+        }
+        buffer->tail.store(head, std::memory_order_release);
+    }
+}
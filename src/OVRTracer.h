@@ -0,0 +1,192 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef OVRTRACER_H
+#define OVRTRACER_H
+
+#include <QString>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * @brief A recorder of trace events in the Chrome trace event format.
+ *
+ * Each thread that records an event is given its own single-producer single-consumer
+ * ring buffer, so recording an event is lock-free and costs a few stores. A background
+ * thread periodically drains the buffers into a JSON file that can be opened with
+ * chrome://tracing or the Perfetto UI. Events that do not fit in a full buffer are
+ * dropped and counted rather than blocking the recording thread.
+ *
+ * When no trace is being recorded, recording an event only costs an atomic load.
+ * Note that event names are not copied, so they must be string literals or otherwise
+ * outlive the trace.
+ */
+class OVRTracer {
+public:
+    /**
+     * @brief Records a begin event when it is created and an end event when it goes out of scope.
+     */
+    class Scope {
+    public:
+        Scope(OVRTracer& tracer, const char* const name);
+        ~Scope();
+    private:
+        OVRTracer& _tracer;
+        const char* const _name;
+    };
+    /**
+     * Instantiate a tracer.
+     */
+    OVRTracer();
+    /**
+     * The destructor. The current trace, if any, is stopped.
+     */
+    ~OVRTracer();
+    /**
+     * Returns the current time in seconds, on the clock used to timestamp events.
+     */
+    static double getTime();
+    /**
+     * @brief Start recording a trace to the specified file. If a trace is already being
+     * recorded, it is stopped first. Returns false if the file could not be opened.
+     *
+     * @param path the file to write.
+     */
+    bool start(const QString& path);
+    /**
+     * @brief Stop recording the current trace. The remaining events are written and the
+     * file is closed.
+     */
+    void stop();
+    /**
+     * Returns true if a trace is being recorded, false otherwise.
+     */
+    bool isTracing() const;
+    /**
+     * Return the number of events dropped during the current or last trace.
+     */
+    unsigned int getDroppedEventCount() const;
+    /**
+     * Record the beginning of a duration on the calling thread.
+     * @param name the event's name.
+     */
+    void begin(const char* const name);
+    /**
+     * Record the end of a duration on the calling thread.
+     * @param name the event's name.
+     */
+    void end(const char* const name);
+    /**
+     * Record a complete duration.
+     * @param name the event's name.
+     * @param start the time (in seconds) at which the duration started.
+     * @param duration the duration in seconds.
+     * @param thread the identifier of the track on which the event is displayed. If
+     * negative, the event is displayed on the calling thread's track.
+     */
+    void complete(const char* const name, const double start, const double duration, const int thread = -1);
+    /**
+     * Record an instantaneous event on the calling thread.
+     * @param name the event's name.
+     */
+    void instant(const char* const name);
+    /**
+     * Record the value of a counter.
+     * @param name the counter's name.
+     * @param value the counter's value.
+     */
+    void counter(const char* const name, const double value);
+private:
+    /**
+     * A trace event.
+     */
+    struct Event {
+        const char* name;
+        char phase;
+        int thread;
+        double time;
+        double value;
+    };
+    /**
+     * A thread's ring buffer. The head is only written by the recording thread and the
+     * tail is only written by the writer thread.
+     */
+    struct Buffer {
+        static constexpr std::size_t CAPACITY = 1 << 14;
+        std::array<OVRTracer::Event, CAPACITY> events;
+        std::atomic<std::size_t> head;
+        std::atomic<std::size_t> tail;
+        int thread;
+    };
+    /**
+     * Record an event on the calling thread's buffer.
+     * @param event the event to record.
+     */
+    void record(const OVRTracer::Event& event);
+    /**
+     * Return the calling thread's buffer, creating it if need be.
+     */
+    OVRTracer::Buffer& getBuffer();
+    /**
+     * The function executed by the writer thread.
+     */
+    void write();
+    /**
+     * Write the events in all buffers to the file.
+     */
+    void drain();
+    /**
+     * The thread buffers, and the mutex that protects the list.
+     */
+    std::vector<std::unique_ptr<OVRTracer::Buffer>> _buffers;
+    std::mutex _buffersMutex;
+    /**
+     * The file the trace is written to, and the time at which the trace started.
+     */
+    std::FILE* _file;
+    double _startTime;
+    /**
+     * True if the file contains at least one event, i.e. the next one needs a separator.
+     */
+    bool _hasEvents;
+    /**
+     * The writer thread.
+     */
+    std::thread _writer;
+    /**
+     * True while a trace is being recorded.
+     */
+    std::atomic<bool> _tracing;
+    /**
+     * The number of events dropped because a buffer was full.
+     */
+    std::atomic<unsigned int> _droppedEventCount;
+};
+
+#endif // OVRTRACER_H
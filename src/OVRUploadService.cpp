@@ -0,0 +1,303 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "OVRUploadService.h"
+#include <QThread>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+
+
+/**
+ * A thread that calls the specified function.
+ */
+class WorkerThread : public QThread {
+public:
+    explicit WorkerThread(std::function<void()> function) :
+    _function(std::move(function)) {}
+protected:
+    void run() override {
+        _function();
+    }
+private:
+    std::function<void()> _function;
+};
+
+
+constexpr unsigned int OVRUploadService::StagingBufferCount;
+
+
+OVRUploadService::OVRUploadService(QOpenGLContext& shareContext) :
+_thread(new WorkerThread([this]() { work(); })),
+_sequence(0),
+_budget({0, 0}),
+_pendingRequestCount(0),
+_staging(),
+_nextStagingBuffer(0),
+_running(true) {
+    _context.setFormat(shareContext.format());
+    _context.setShareContext(&shareContext);
+    const auto result = _context.create();
+    assert(result);
+    assert(QOpenGLContext::areSharing(&_context, &shareContext));
+
+    // The surface must be created on the GUI thread, but may be used by the worker.
+    _surface.setFormat(_context.format());
+    _surface.create();
+    assert(_surface.isValid());
+
+    _context.moveToThread(_thread.get());
+    _thread->start();
+}
+
+
+OVRUploadService::~OVRUploadService() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+    _condition.notify_all();
+    _thread->wait();
+}
+
+
+void
+OVRUploadService::uploadTexture(const QImage& image, OVRUploadService::Callback callback, const OVRUploadService::Priority priority) {
+    assert(!image.isNull());
+    const qint64 size = 4 * static_cast<qint64>(image.width()) * image.height();
+    enqueue({priority, 0, GL_TEXTURE_2D, image, QByteArray(), size, std::move(callback)});
+}
+
+
+void
+OVRUploadService::uploadBuffer(const GLenum target, const QByteArray& data, OVRUploadService::Callback callback, const OVRUploadService::Priority priority) {
+    assert(target != GL_TEXTURE_2D);
+    enqueue({priority, 0, target, QImage(), data, data.size(), std::move(callback)});
+}
+
+
+qint64
+OVRUploadService::getFrameByteBudget() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _budget.size;
+}
+
+
+void
+OVRUploadService::setFrameByteBudget(const qint64 budget) {
+    assert(budget >= 0);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _budget.size = budget;
+        _budget.remaining = budget;
+    }
+    _condition.notify_one();
+}
+
+
+unsigned int
+OVRUploadService::getPendingRequestCount() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _pendingRequestCount;
+}
+
+
+void
+OVRUploadService::beginFrame() {
+    // Collect the uploads whose fences have been signaled. The callbacks are invoked
+    // once the mutex is released, since they may make new requests.
+    std::vector<OVRUploadService::Upload> completed;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const auto& begin = std::stable_partition(_uploads.begin(), _uploads.end(), [](const OVRUploadService::Upload& upload) {
+            return glClientWaitSync(upload.fence, 0, 0) == GL_TIMEOUT_EXPIRED;
+        });
+        completed.assign(std::make_move_iterator(begin), std::make_move_iterator(_uploads.end()));
+        _uploads.erase(begin, _uploads.end());
+        _pendingRequestCount -= static_cast<unsigned int>(completed.size());
+        _budget.remaining = _budget.size;
+    }
+    _condition.notify_one();
+
+    for (const auto& upload : completed) {
+        glDeleteSync(upload.fence);
+        upload.callback(upload.handle);
+    }
+}
+
+
+bool
+OVRUploadService::isServedAfter(const OVRUploadService::Request& a, const OVRUploadService::Request& b) {
+    return a.priority != b.priority ? a.priority < b.priority : a.sequence > b.sequence;
+}
+
+
+void
+OVRUploadService::enqueue(OVRUploadService::Request&& request) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        request.sequence = _sequence++;
+        _requests.push_back(std::move(request));
+        std::push_heap(_requests.begin(), _requests.end(), &OVRUploadService::isServedAfter);
+        ++_pendingRequestCount;
+    }
+    _condition.notify_one();
+}
+
+
+void
+OVRUploadService::work() {
+    const auto result = _context.makeCurrent(&_surface);
+    assert(result);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        // A request is served if it fits in what is left of the frame's budget, or if
+        // nothing has been uploaded during the frame yet.
+        _condition.wait(lock, [this]() {
+            if (!_running)
+                return true;
+            if (_requests.empty())
+                return false;
+            const auto& budget = _budget;
+            return budget.size == 0 || budget.remaining == budget.size || _requests.front().size <= budget.remaining;
+        });
+        if (!_running)
+            break;
+
+        std::pop_heap(_requests.begin(), _requests.end(), &OVRUploadService::isServedAfter);
+        auto request = std::move(_requests.back());
+        _requests.pop_back();
+        _budget.remaining -= request.size;
+        const auto budget = _budget.size;
+        lock.unlock();
+
+        // The fence must be flushed before the rendering context can wait on it.
+        const auto& handle = upload(request, budget);
+        const auto& fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+
+        lock.lock();
+        _uploads.push_back({request.target, handle, fence, std::move(request.callback)});
+    }
+
+    // Delete the objects that were never delivered.
+    for (const auto& upload : _uploads) {
+        glDeleteSync(upload.fence);
+        if (upload.target == GL_TEXTURE_2D)
+            glDeleteTextures(1, &upload.handle);
+        else
+            glDeleteBuffers(1, &upload.handle);
+    }
+    _uploads.clear();
+    lock.unlock();
+
+    // Delete the staging buffers.
+    for (auto& staging : _staging) {
+        if (staging.fence != nullptr)
+            glDeleteSync(staging.fence);
+        if (staging.buffer != 0)
+            glDeleteBuffers(1, &staging.buffer);
+        staging = {0, 0, nullptr};
+    }
+
+    // Hand the context back to the GUI thread, where it will be destroyed.
+    _context.doneCurrent();
+    _context.moveToThread(_surface.thread());
+}
+
+
+GLuint
+OVRUploadService::upload(const OVRUploadService::Request& request, const qint64 budget) {
+    GLuint handle = 0;
+    if (request.target == GL_TEXTURE_2D) {
+        // Note that RGBA scanlines are always 32-bit aligned, which matches OpenGL's
+        // default unpack alignment.
+        const auto& image = request.image.convertToFormat(QImage::Format_RGBA8888).mirrored();
+
+        // The texture is filled from the staging buffer without blocking the worker.
+        auto& staging = stage(image.constBits(), request.size, budget);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging.buffer);
+        glGenTextures(1, &handle);
+        glBindTexture(GL_TEXTURE_2D, handle);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.width(), image.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        staging.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    } else {
+        // The buffer object's type is not tied to the target it is created with, so it is
+        // filled through GL_COPY_WRITE_BUFFER.
+        glGenBuffers(1, &handle);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, handle);
+        glBufferData(GL_COPY_WRITE_BUFFER, request.size, nullptr, GL_STATIC_DRAW);
+        if (request.size > 0) {
+            auto& staging = stage(request.data.constData(), request.size, budget);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, request.size);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            staging.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    assert(handle != 0);
+    return handle;
+}
+
+
+OVRUploadService::StagingBuffer&
+OVRUploadService::stage(const void* const data, const qint64 size, const qint64 budget) {
+    auto& staging = _staging[_nextStagingBuffer];
+    _nextStagingBuffer = (_nextStagingBuffer + 1) % OVRUploadService::StagingBufferCount;
+
+    // The buffer is reused once the GPU has finished reading it, which it usually has by
+    // the time the ring wraps around.
+    if (staging.fence != nullptr) {
+        while (glClientWaitSync(staging.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {}
+        glDeleteSync(staging.fence);
+        staging.fence = nullptr;
+    }
+    if (staging.buffer == 0) {
+        glGenBuffers(1, &staging.buffer);
+        assert(staging.buffer != 0);
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, staging.buffer);
+
+    // The buffer only grows, to the frame byte budget or to fit a larger request.
+    const auto& capacity = std::max(size, budget);
+    if (staging.capacity < capacity) {
+        glBufferData(GL_COPY_READ_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+        staging.capacity = capacity;
+    }
+
+    // The GPU no longer reads the buffer, so it is mapped without synchronization.
+    const auto& access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    void* const destination = glMapBufferRange(GL_COPY_READ_BUFFER, 0, size, access);
+    assert(destination != nullptr);
+    std::memcpy(destination, data, static_cast<std::size_t>(size));
+    glUnmapBuffer(GL_COPY_READ_BUFFER);
+    return staging;
+}
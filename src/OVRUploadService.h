@@ -0,0 +1,254 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef OVRUPLOADSERVICE_H
+#define OVRUPLOADSERVICE_H
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES
+#endif
+
+#include <QOpenGLContext>
+#include <QOffscreenSurface>
+#include <QByteArray>
+#include <QImage>
+#include <array>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+class QThread;
+
+/**
+ * @brief A service that uploads textures and buffers in the background.
+ *
+ * Uploads are performed by a worker thread with its own OpenGL context, which shares its
+ * objects with the rendering context. Once an upload has been submitted to the GPU, a
+ * fence is inserted into the worker's command stream. The rendering thread polls these
+ * fences at the start of each frame (see beginFrame) and invokes an upload's callback
+ * with the new object's handle once the object is complete, at which point the object
+ * may be used by the rendering context.
+ *
+ * Requests are served in order of priority, then in the order in which they were made.
+ * To keep uploads from competing with the rendering thread for bandwidth, the worker
+ * stops once the number of bytes uploaded during the current frame exceeds the frame
+ * byte budget. A request that is larger than the budget is still served, but only at
+ * the start of a frame.
+ *
+ * The data is copied into a small ring of persistent staging buffers, from which the
+ * GPU fills the new objects. Each staging buffer is sized to the frame byte budget, or
+ * to the largest request it served, and is fenced so that it is only overwritten once
+ * the GPU has finished reading it.
+ */
+class OVRUploadService {
+public:
+    /**
+     * An enumeration of upload priorities.
+     */
+    enum class Priority : unsigned int {
+        Low,
+        Normal,
+        High,
+    };
+    /**
+     * The function called on the rendering thread once an upload is complete. The caller
+     * takes ownership of the object, which it must delete with the rendering context.
+     */
+    using Callback = std::function<void(const GLuint handle)>;
+    /**
+     * @brief Instantiate an upload service and start its worker thread.
+     *
+     * This must be called from the GUI thread.
+     * @param shareContext the rendering context with which uploaded objects are shared.
+     */
+    explicit OVRUploadService(QOpenGLContext& shareContext);
+    /**
+     * @brief The destructor. Pending requests are discarded, and objects that have been
+     * uploaded but not delivered are deleted.
+     */
+    ~OVRUploadService();
+    /**
+     * @brief Upload an image to a new mipmapped 2D texture.
+     *
+     * The image is converted to RGBA and flipped vertically so that its first scanline
+     * is at the bottom of the texture, then staged through a staging buffer.
+     * @param image the image to upload.
+     * @param callback the function called with the texture once it is complete.
+     * @param priority the request's priority.
+     */
+    void uploadTexture(const QImage& image, OVRUploadService::Callback callback, const OVRUploadService::Priority priority = OVRUploadService::Priority::Normal);
+    /**
+     * @brief Upload data to a new buffer object, e.g. a vertex or index buffer.
+     *
+     * The data is staged through a staging buffer, from which the new buffer is filled
+     * by the GPU.
+     * @param target the buffer's binding target, e.g. GL_ARRAY_BUFFER.
+     * @param data the data to upload.
+     * @param callback the function called with the buffer once it is complete.
+     * @param priority the request's priority.
+     */
+    void uploadBuffer(const GLenum target, const QByteArray& data, OVRUploadService::Callback callback, const OVRUploadService::Priority priority = OVRUploadService::Priority::Normal);
+    /**
+     * Return the number of bytes that may be uploaded per frame.
+     */
+    qint64 getFrameByteBudget() const;
+    /**
+     * Set the number of bytes that may be uploaded per frame. If the budget is zero,
+     * the number of bytes is not limited.
+     * @param budget the budget to set.
+     */
+    void setFrameByteBudget(const qint64 budget);
+    /**
+     * Return the number of requests that have not been delivered yet.
+     */
+    unsigned int getPendingRequestCount() const;
+    /**
+     * @brief Begin a new frame.
+     *
+     * This delivers the uploads that are complete by invoking their callbacks, then resets
+     * the frame's byte budget. It must be called on the rendering thread while the
+     * rendering context is current.
+     */
+    void beginFrame();
+private:
+    /**
+     * An upload request.
+     */
+    struct Request {
+        OVRUploadService::Priority priority;
+        quint64 sequence;
+        GLenum target;
+        QImage image;
+        QByteArray data;
+        qint64 size;
+        OVRUploadService::Callback callback;
+    };
+    /**
+     * An upload that has been submitted to the GPU but not delivered yet.
+     */
+    struct Upload {
+        GLenum target;
+        GLuint handle;
+        GLsync fence;
+        OVRUploadService::Callback callback;
+    };
+    /**
+     * The number of staging buffers in the ring.
+     */
+    static constexpr unsigned int StagingBufferCount = 3;
+    /**
+     * A staging buffer, its capacity in bytes, and the fence that is signaled once the
+     * GPU has finished reading it.
+     */
+    struct StagingBuffer {
+        GLuint buffer;
+        qint64 capacity;
+        GLsync fence;
+    };
+    /**
+     * Returns true if request a is served after request b, i.e. if it has a lower priority
+     * or, if both have the same priority, was made later.
+     * @param a the first request.
+     * @param b the second request.
+     */
+    static bool isServedAfter(const OVRUploadService::Request& a, const OVRUploadService::Request& b);
+    /**
+     * Queue a request.
+     * @param request the request to queue.
+     */
+    void enqueue(OVRUploadService::Request&& request);
+    /**
+     * The function executed by the worker thread.
+     */
+    void work();
+    /**
+     * Upload a request's data and return the new object's handle. This is called by
+     * the worker thread.
+     * @param request the request to serve.
+     * @param budget the frame byte budget, to which the staging buffers are sized.
+     */
+    GLuint upload(const OVRUploadService::Request& request, const qint64 budget);
+    /**
+     * @brief Copy data into the next staging buffer in the ring, which is left bound to
+     * GL_COPY_READ_BUFFER. This is called by the worker thread.
+     *
+     * If the GPU has not finished reading the buffer's previous contents, the worker
+     * waits until it has. The caller must fence the buffer once its commands are issued.
+     * @param data the data to copy.
+     * @param size the number of bytes to copy.
+     * @param budget the frame byte budget, to which the buffer is sized.
+     */
+    OVRUploadService::StagingBuffer& stage(const void* const data, const qint64 size, const qint64 budget);
+    /**
+     * The worker's OpenGL context and the surface it is made current with.
+     */
+    QOpenGLContext _context;
+    QOffscreenSurface _surface;
+    /**
+     * The worker thread.
+     */
+    std::unique_ptr<QThread> _thread;
+    /**
+     * The requests, ordered in a heap.
+     */
+    std::vector<OVRUploadService::Request> _requests;
+    /**
+     * The sequence number given to the next request.
+     */
+    quint64 _sequence;
+    /**
+     * The frame byte budget and the number of bytes left in the current frame.
+     */
+    struct {
+        qint64 size;
+        qint64 remaining;
+    } _budget;
+    /**
+     * The uploads that have been submitted to the GPU but not delivered yet.
+     */
+    std::vector<OVRUploadService::Upload> _uploads;
+    /**
+     * The number of requests that have not been delivered yet.
+     */
+    unsigned int _pendingRequestCount;
+    /**
+     * The ring of staging buffers and the index of the next one to be used, which are
+     * only accessed by the worker thread.
+     */
+    std::array<OVRUploadService::StagingBuffer, OVRUploadService::StagingBufferCount> _staging;
+    unsigned int _nextStagingBuffer;
+    /**
+     * The mutex that protects the requests, the budget and the uploads. The worker sleeps
+     * on the condition variable until a request may be served.
+     */
+    mutable std::mutex _mutex;
+    std::condition_variable _condition;
+    /**
+     * False when the worker needs to stop.
+     */
+    bool _running;
+};
+
+#endif // OVRUPLOADSERVICE_H
@@ -27,9 +27,26 @@
 #include <qpa/qplatformnativeinterface.h>
 #include <QResizeEvent>
 #include <QExposeEvent>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QOffscreenSurface>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLPaintDevice>
+#include <QOpenGLShaderProgram>
+#include <QPainter>
 #include <QMap>
 #include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
 #include <atomic>
+#include <limits>
+#include <numeric>
+#include <type_traits>
 #if defined(Q_OS_LINUX)
 #define OVR_OS_LINUX
 #elif defined(Q_OS_MAC)
@@ -56,6 +73,325 @@ getXDisplay(QWindow* const window) {
 #endif
 
 
+/**
+ * Annotates a pass: a debug group is pushed onto the command stream (KHR_debug) and a
+ * trace event is begun, then both are ended when the annotation goes out of scope. This
+ * allows frames to be navigated in tools such as apitrace, RenderDoc or chrome://tracing.
+ */
+class Annotation {
+public:
+    Annotation(const bool debug, OVRTracer& tracer, const char* const name) :
+    _debug(debug),
+    _tracer(tracer),
+    _name(name) {
+        if (_debug)
+            glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, _name);
+        _tracer.begin(_name);
+    }
+    ~Annotation() {
+        _tracer.end(_name);
+        if (_debug)
+            glPopDebugGroup();
+    }
+private:
+    const bool _debug;
+    OVRTracer& _tracer;
+    const char* const _name;
+};
+
+
+/**
+ * The names of the passes in which each eye is painted, and of their GPU timings.
+ */
+static const char* const EYE_PASSES[ovrEye_Count] = {"Left eye", "Right eye"};
+static const char* const EYE_GPU_PASSES[ovrEye_Count] = {"Left eye (GPU)", "Right eye (GPU)"};
+
+
+/**
+ * The trace tracks on which GPU timings and the job system's workers are displayed.
+ */
+static constexpr int GPU_TRACE_THREAD = 0;
+static constexpr int JOB_TRACE_THREAD = 100;
+
+
+/**
+ * The number of latency measurements the latency statistics are computed from.
+ */
+static constexpr int LATENCY_MEASUREMENT_COUNT = 16;
+
+
+/**
+ * The width (in seconds) and the number of the input latency histogram's bins.
+ */
+static constexpr float INPUT_LATENCY_BIN_WIDTH = 0.002f;
+static constexpr int INPUT_LATENCY_BIN_COUNT = 100;
+
+
+/**
+ * Returns true if an event of the specified type is an input event, false otherwise.
+ * @param type the event's type.
+ */
+static bool
+isInputEvent(const QEvent::Type type) {
+    switch (type) {
+        case QEvent::KeyPress:
+        case QEvent::KeyRelease:
+        case QEvent::MouseButtonPress:
+        case QEvent::MouseButtonRelease:
+        case QEvent::MouseButtonDblClick:
+        case QEvent::MouseMove:
+        case QEvent::Wheel:
+        case QEvent::TouchBegin:
+        case QEvent::TouchUpdate:
+        case QEvent::TouchEnd:
+        case QEvent::TabletPress:
+        case QEvent::TabletMove:
+        case QEvent::TabletRelease:
+            return true;
+        default:
+            return false;
+    }
+}
+
+
+/**
+ * Parses a result reported by the latency tester, e.g. "RESULT=23.5 (min=21 max=25)",
+ * and returns the measured latency in seconds. Returns a negative value if the result
+ * could not be parsed.
+ * @param result the result to parse.
+ */
+static float
+parseLatencyTestResult(const char* const result) {
+    const char* const value = std::strstr(result, "RESULT=");
+    if (value != nullptr) {
+        char* end = nullptr;
+        const auto& milliseconds = std::strtof(value + std::strlen("RESULT="), &end);
+        if (end != value + std::strlen("RESULT="))
+            return 0.001f * milliseconds;
+    }
+    return -1.0f;
+}
+
+
+/**
+ * The names of the levels of detail and features, as they appear in LOD profile files.
+ */
+static const char* const LOD_NAMES[] = {"Lowest", "Low", "Medium", "High", "Highest"};
+static const struct {
+    const char* name;
+    OVRWindow::Feature feature;
+} FEATURE_NAMES[] = {
+    {"LowPersistence", OVRWindow::Feature::LowPersistence},
+    {"LatencyTesting", OVRWindow::Feature::LatencyTesting},
+    {"DynamicPrediction", OVRWindow::Feature::DynamicPrediction},
+    {"OrientationTracking", OVRWindow::Feature::OrientationTracking},
+    {"YawCorrection", OVRWindow::Feature::YawCorrection},
+    {"PositionalTracking", OVRWindow::Feature::PositionalTracking},
+    {"ChromaticAberrationCorrection", OVRWindow::Feature::ChromaticAberrationCorrection},
+    {"Timewarp", OVRWindow::Feature::Timewarp},
+    {"Vignette", OVRWindow::Feature::Vignette},
+};
+
+
+/**
+ * The default profile of each level of detail, from lowest to highest.
+ */
+static const QVector<OVRWindow::LODProfile> DEFAULT_LOD_PROFILES = {
+    {0.25f, 0.8f, 0.8f, false, 8, true,  true,  {{OVRWindow::Feature::ChromaticAberrationCorrection, false}}},
+    {0.5f,  1.0f, 1.0f, false, 4, false, true,  {{OVRWindow::Feature::ChromaticAberrationCorrection, false}}},
+    {1.0f,  1.2f, 1.2f, true,  2, false, false, {{OVRWindow::Feature::ChromaticAberrationCorrection, true}}},
+    {1.0f,  0.0f, 0.0f, true,  1, false, false, {{OVRWindow::Feature::ChromaticAberrationCorrection, true}}},
+    {1.5f,  0.0f, 0.0f, true,  1, false, false, {{OVRWindow::Feature::ChromaticAberrationCorrection, true}}},
+};
+
+
+/**
+ * Parses a level of detail's profile, overriding the settings it specifies. Returns
+ * false if the profile is invalid.
+ * @param object the profile to parse.
+ * @param profile the profile whose settings are overridden.
+ */
+static bool
+parseLODProfile(const QJsonObject& object, OVRWindow::LODProfile& profile) {
+    if (object.contains("pixelDensity")) {
+        const auto& value = object.value("pixelDensity");
+        if (!value.isDouble())
+            return false;
+        profile.pixelDensity = static_cast<float>(value.toDouble());
+    }
+    if (object.contains("fov")) {
+        const auto& value = object.value("fov").toArray();
+        if (value.size() != 2 || !value.at(0).isDouble() || !value.at(1).isDouble())
+            return false;
+        profile.horizontalFOV = static_cast<float>(value.at(0).toDouble());
+        profile.verticalFOV = static_cast<float>(value.at(1).toDouble());
+    }
+    if (object.contains("multisampling")) {
+        const auto& value = object.value("multisampling");
+        if (!value.isBool())
+            return false;
+        profile.multisampling = value.toBool();
+    }
+    if (object.contains("distortionMeshDecimation")) {
+        const auto& value = object.value("distortionMeshDecimation");
+        if (!value.isDouble() || value.toInt() < 1)
+            return false;
+        profile.distortionMeshDecimation = static_cast<unsigned int>(value.toInt());
+    }
+    if (object.contains("alternateEyes")) {
+        const auto& value = object.value("alternateEyes");
+        if (!value.isBool())
+            return false;
+        profile.alternateEyes = value.toBool();
+    }
+    if (object.contains("temporalUpsampling")) {
+        const auto& value = object.value("temporalUpsampling");
+        if (!value.isBool())
+            return false;
+        profile.temporalUpsampling = value.toBool();
+    }
+    if (object.contains("features")) {
+        const auto& value = object.value("features");
+        if (!value.isObject())
+            return false;
+        const auto& features = value.toObject();
+        unsigned int count = 0;
+        for (const auto& entry : FEATURE_NAMES) {
+            if (features.contains(entry.name)) {
+                const auto& enable = features.value(entry.name);
+                if (!enable.isBool())
+                    return false;
+                profile.features[entry.feature] = enable.toBool();
+                ++count;
+            }
+        }
+        // Any other key is an unknown feature.
+        if (count != static_cast<unsigned int>(features.size()))
+            return false;
+    }
+    return true;
+}
+
+
+/**
+ * The smallest tangent of an FOV half-angle, which prevents degenerate projections.
+ */
+static constexpr float MINIMUM_FOV_TANGENT = 0.1f;
+
+
+/**
+ * The size (in pixels) of the quad that is flashed in front of the latency tester.
+ */
+static constexpr GLsizei LATENCY_TEST_QUAD_SIZE = 32;
+
+
+/**
+ * The number of sub-pixel jitter offsets used by temporal upsampling before the sequence
+ * repeats, and the weight of the current frame when it is accumulated into the output.
+ */
+static constexpr unsigned int UPSAMPLING_JITTER_COUNT = 8;
+static constexpr float UPSAMPLING_BLEND = 0.1f;
+
+
+/**
+ * Returns an element of the Halton sequence in [0, 1), which is used to distribute the
+ * sub-pixel jitter evenly.
+ * @param index the element's index, starting from 1.
+ * @param base the sequence's base.
+ */
+static float
+getHaltonNumber(unsigned int index, const unsigned int base) {
+    auto result = 0.0f;
+    auto fraction = 1.0f;
+    while (index > 0) {
+        fraction /= base;
+        result += fraction * (index % base);
+        index /= base;
+    }
+    return result;
+}
+
+
+/**
+ * Returns the indices of a distortion mesh whose grid is decimated, i.e. only every
+ * decimation-th row and column of vertices is kept, as well as the last ones. If the
+ * mesh's vertices do not form a square grid, its own indices are returned.
+ * @param mesh the mesh to decimate.
+ * @param decimation the number of grid cells that are merged into one in each direction.
+ */
+static QVector<unsigned short>
+decimateDistortionMesh(const ovrDistortionMesh& mesh, const unsigned int decimation) {
+    const auto& side = static_cast<unsigned int>(std::lround(std::sqrt(mesh.VertexCount)));
+    if (decimation <= 1 || side < 2 || side * side != mesh.VertexCount) {
+        QVector<unsigned short> indices(mesh.IndexCount);
+        std::copy(mesh.pIndexData, mesh.pIndexData + mesh.IndexCount, indices.begin());
+        return indices;
+    }
+    QVector<unsigned int> lines;
+    for (unsigned int i = 0; i < side - 1; i += decimation) {
+        lines.append(i);
+    }
+    lines.append(side - 1);
+
+    QVector<unsigned short> indices;
+    indices.reserve(6 * (lines.size() - 1) * (lines.size() - 1));
+    for (int y = 0; y < lines.size() - 1; ++y) {
+        for (int x = 0; x < lines.size() - 1; ++x) {
+            const auto& topLeft = static_cast<unsigned short>(lines[y] * side + lines[x]);
+            const auto& topRight = static_cast<unsigned short>(lines[y] * side + lines[x + 1]);
+            const auto& bottomLeft = static_cast<unsigned short>(lines[y + 1] * side + lines[x]);
+            const auto& bottomRight = static_cast<unsigned short>(lines[y + 1] * side + lines[x + 1]);
+            indices << topLeft << topRight << bottomRight << topLeft << bottomRight << bottomLeft;
+        }
+    }
+    return indices;
+}
+
+
+/**
+ * Returns how far apart two head poses are: the angle (in radians) between their
+ * orientations plus the distance (in meters) between their positions. This is roughly
+ * how far (in meters) a point one meter in front of the viewer moves.
+ * @param a the first pose.
+ * @param b the second pose.
+ */
+static float
+getPoseDelta(const ovrPosef& a, const ovrPosef& b) {
+    const auto& p = a.Orientation;
+    const auto& q = b.Orientation;
+    const auto& dot = std::min(std::abs(p.x * q.x + p.y * q.y + p.z * q.z + p.w * q.w), 1.0f);
+    const auto& dx = a.Position.x - b.Position.x;
+    const auto& dy = a.Position.y - b.Position.y;
+    const auto& dz = a.Position.z - b.Position.z;
+    return 2.0f * std::acos(dot) + std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+
+/**
+ * The size of a uniform block in the transform buffer, i.e. four matrices.
+ */
+static constexpr GLint TRANSFORM_BLOCK_SIZE = 4 * 16 * sizeof(GLfloat);
+
+
+/**
+ * The number of frames in the shared memory ring to which frames are exported. Readers
+ * have this many frames' time to read a frame before it is overwritten.
+ */
+static constexpr unsigned int EXPORT_RING_SIZE = 4;
+
+
+/**
+ * Returns the view rotation matrix, i.e. the inverse of the head's orientation, for
+ * the specified pose.
+ */
+QMatrix4x4
+getViewRotation(const ovrPosef& pose) {
+    // Note that both OVR::Matrix4f and QMatrix4x4's constructor use a row-major order.
+    const OVR::Matrix4f rotation(OVR::Quatf(pose.Orientation).Inverted());
+    return QMatrix4x4(&rotation.M[0][0]);
+}
+
+
 /**
  * Returns the specified OVRWindow::Feature's hash value, as required by QSet.
  * @param feature the feature identifier to hash.
@@ -68,18 +404,47 @@ qHash(const OVRWindow::Feature feature) {
 }
 
 
+constexpr GLuint OVRWindow::TransformBufferBinding;
+constexpr unsigned int OVRWindow::FrameSlotCount;
+
+
 OVRWindow::OVRWindow(const unsigned int index, const std::initializer_list<OVRWindow::Feature>& features) :
 QWindow(static_cast<QScreen*>(nullptr)),
 _device(),
+_offscreen({nullptr, 0.0, false}),
 _pendingUpdateRequest(false),
-_renderTarget({0, 0, 0, QSize(0, 0)}),
+_renderTarget({0, 0, 0, 0, QSize(0, 0)}),
 _nearClippingPlaneDistance(0.01f),
 _farClippingPlaneDistance(10000.0f),
 _forceZeroIPD(false),
 _pixelDensity(1.0f),
 _vision(OVRWindow::Vision::Binocular),
 _LOD(OVRWindow::LOD::Highest),
-_dirty({true, true, {true, true}, {true, true}}) {
+_LODProfiles(DEFAULT_LOD_PROFILES),
+_dirty({true, true, true, {true, true}, {true, true}}),
+_reconfigurations({0, 0, 0, 0}),
+_HUD({false, true, QSize(1024, 512), 0.0f, 0.0, 0, nullptr, nullptr}),
+_reprojection({false, false, 0.0f, 0, {false, false}, {0.0, 0.0}, {}, 0, nullptr}),
+_alternateEye({false, ovrEye_Left}),
+_upsampling({false, false, false, 0, {0, 0}, {0, 0}, QSize(), 0, {0.0f, 0.0f}, {}, {}, 0, 0, nullptr}),
+_transformBuffer({false, 0, 0, nullptr}),
+_frames({2, 0, {nullptr, nullptr, nullptr}}),
+_distortion({false, true, false, 1, {}, {}, {}, 0, {}, nullptr}),
+_idle({false, false, false, false, 0.002f, 0}),
+_export({false, QString(), OVRWindow::FrameExportSource::EyeBuffers, nullptr, false, {}, {}, {}, 0}),
+_jobs(),
+_uploadService(nullptr),
+_occlusionCuller(),
+_glState(),
+_synchronizeGLState(false),
+_vertexArray(0),
+_debug({false, false, {}}),
+_tracer(),
+_gpuTimers({{}, {}, {}, 0, false}),
+_latency({false, 0.0, 0.0, QVector<float>(), 0, {0.0f, 0.0f, 0.0f, 0.0f, 0}}),
+_inputLatency(),
+_sensorSampler(nullptr),
+_update({false, nullptr}) {
     // Only one instance of this class can be created.
     static std::atomic<bool> OVRWINDOW_INSTANTIATED(false);
     assert(!OVRWINDOW_INSTANTIATED);
@@ -95,13 +460,20 @@ _dirty({true, true, {true, true}, {true, true}}) {
 
     // Initialize the HMD device. If no device is detected, create a debug device.
     auto hmd = ovrHmd_Create(index);
-    if (!hmd)
+    if (!hmd) {
         hmd = ovrHmd_CreateDebug(ovrHmd_DK1);
+        _latency.simulated = true;
+    }
     ovrHmd_GetDesc(hmd, const_cast<ovrHmdDesc*>(&_device));
+    _sensorSampler.reset(new OVRSensorSampler(hmd));
 
     // Initialize the FOV parameters.
     std::copy(std::begin(_device.DefaultEyeFov), std::end(_device.DefaultEyeFov), _FOV);
 
+    // The input latency measurements hold a mutex, so they are not initialized in place.
+    _inputLatency.count = 0;
+    resetInputLatencyHistogram();
+
     // Enable features.
     enableFeatures(features);
 }
@@ -122,9 +494,62 @@ OVRWindow(0, {
 
 
 OVRWindow::~OVRWindow() {
+    // Wait for a pending frame update.
+    if (_update.job != nullptr)
+        _jobs.wait(_update.job);
+
+    // The OpenGL resources can only be deleted while the context is current.
+    const bool isCurrent = hasValidGL();
+    if (isCurrent)
+        makeCurrent();
+
     if (_renderTarget.pixel != 0)
         glDeleteTextures(1, &_renderTarget.pixel);
 
+    if (_renderTarget.history != 0)
+        glDeleteTextures(1, &_renderTarget.history);
+
+    if (_gpuTimers.queries[0][0] != 0) {
+        glDeleteQueries(static_cast<GLsizei>(_gpuTimers.queries.size() * ovrEye_Count), _gpuTimers.queries[0].data());
+        glDeleteQueries(static_cast<GLsizei>(_gpuTimers.timestamps.size() * ovrEye_Count), _gpuTimers.timestamps[0].data());
+    }
+
+    for (auto& fence : _frames.fences) {
+        if (fence != nullptr)
+            glDeleteSync(fence);
+    }
+
+    if (_transformBuffer.buffer != 0)
+        glDeleteBuffers(1, &_transformBuffer.buffer);
+
+    if (_export.buffers[0] != 0)
+        glDeleteBuffers(static_cast<GLsizei>(_export.buffers.size()), _export.buffers.data());
+
+    if (_HUD.vbo != 0)
+        glDeleteBuffers(1, &_HUD.vbo);
+
+    if (_reprojection.vbo != 0)
+        glDeleteBuffers(1, &_reprojection.vbo);
+
+    if (_vertexArray != 0)
+        glDeleteVertexArrays(1, &_vertexArray);
+
+    if (_upsampling.textures[0] != 0) {
+        glDeleteFramebuffers(2, _upsampling.fbos);
+        glDeleteTextures(2, _upsampling.textures);
+    }
+
+    if (_upsampling.sampler != 0) {
+        glDeleteBuffers(1, &_upsampling.vbo);
+        glDeleteSamplers(1, &_upsampling.sampler);
+    }
+
+    if (_distortion.sampler != 0) {
+        glDeleteBuffers(ovrEye_Count, _distortion.vbo.data());
+        glDeleteBuffers(ovrEye_Count, _distortion.ibo.data());
+        glDeleteSamplers(1, &_distortion.sampler);
+    }
+
     //FIXME Find out why these cause a segmentation fault in Qt5.
     //if (_renderTarget.depth != 0)
         //glDeleteRenderbuffers(1, &_renderTarget.depth);
@@ -132,7 +557,20 @@ OVRWindow::~OVRWindow() {
 //   if (_renderTarget.fbo != 0)
 //      glDeleteFramebuffers(1, &_renderTarget.fbo);
 
-    // Destroy the device and shutdown LibOVR.
+    // The objects that own OpenGL resources are also released while the context is
+    // current, rather than when the members are destroyed.
+    _occlusionCuller.release();
+    _HUD.framebuffer.reset();
+    _HUD.program.reset();
+    _reprojection.program.reset();
+    _upsampling.program.reset();
+    _distortion.program.reset();
+    _uploadService.reset();
+    if (isCurrent)
+        doneCurrent();
+
+    // Stop sampling the sensor, then destroy the device and shutdown LibOVR.
+    _sensorSampler.reset();
     ovrHmd_Destroy(_device.Handle);
     ovr_Shutdown();
 }
@@ -150,6 +588,18 @@ void
 OVRWindow::paintGL(const ovrEyeType, const OVRWindow::RenderTransforms&, const float) {}
 
 
+void
+OVRWindow::updateFrame(const float, const ovrFrameTiming&) {}
+
+
+void
+OVRWindow::swapFrameState() {}
+
+
+void
+OVRWindow::paintHUD(QPainter&, const QSize&) {}
+
+
 bool
 OVRWindow::hasValidGL() const {
     return _gl.isValid();
@@ -164,7 +614,8 @@ OVRWindow::getGL() {
 
 void
 OVRWindow::makeCurrent() {
-    const auto& result = _gl.makeCurrent(this);
+    QSurface* const surface = isOffscreen() ? static_cast<QSurface*>(_offscreen.surface.get()) : this;
+    const auto& result = _gl.makeCurrent(surface);
     assert(result);
 }
 
@@ -175,6 +626,146 @@ OVRWindow::doneCurrent() {
 }
 
 
+OVRJobSystem&
+OVRWindow::getJobSystem() {
+    return _jobs;
+}
+
+
+OVRUploadService&
+OVRWindow::getUploadService() {
+    assert(_uploadService != nullptr);
+    return *_uploadService;
+}
+
+
+OVROcclusionCuller&
+OVRWindow::getOcclusionCuller() {
+    return _occlusionCuller;
+}
+
+
+OVRGLState&
+OVRWindow::getGLState() {
+    return _glState;
+}
+
+
+bool
+OVRWindow::isGLStateSynchronizationEnabled() const {
+    return _synchronizeGLState;
+}
+
+
+void
+OVRWindow::enableGLStateSynchronization(const bool enable) {
+    _synchronizeGLState = enable;
+}
+
+
+bool
+OVRWindow::isDebugAnnotationEnabled() const {
+    return _debug.enabled;
+}
+
+
+void
+OVRWindow::enableDebugAnnotations(const bool enable) {
+    _debug.enabled = enable;
+}
+
+
+const OVRGLCallCounts&
+OVRWindow::getGLCallCounts(const ovrEyeType eye) const {
+    return _debug.callCounts[eye];
+}
+
+
+bool
+OVRWindow::startTrace(const QString& path) {
+    return _tracer.start(path);
+}
+
+
+void
+OVRWindow::stopTrace() {
+    _tracer.stop();
+}
+
+
+OVRTracer&
+OVRWindow::getTracer() {
+    return _tracer;
+}
+
+
+const OVRWindow::LatencyStatistics&
+OVRWindow::getLatencyStatistics() const {
+    return _latency.statistics;
+}
+
+
+bool
+OVRWindow::isLatencySimulated() const {
+    return _latency.simulated;
+}
+
+
+unsigned int
+OVRWindow::getLastInputEvent() const {
+    return _inputLatency.count;
+}
+
+
+void
+OVRWindow::consumeInputEvent(const unsigned int event) {
+    std::lock_guard<std::mutex> lock(_inputLatency.mutex);
+
+    // Events that were overwritten by more recent ones cannot be tagged.
+    const auto& size = static_cast<unsigned int>(_inputLatency.times.size());
+    if (event == 0 || event > _inputLatency.count || _inputLatency.count - event >= size)
+        return;
+
+    // A negative time marks an event as consumed.
+    auto& time = _inputLatency.times[event % size];
+    if (time >= 0.0) {
+        _inputLatency.tagged.append(time);
+        time = -1.0;
+    }
+}
+
+
+const OVRWindow::InputLatencyHistogram&
+OVRWindow::getInputLatencyHistogram() const {
+    return _inputLatency.histogram;
+}
+
+
+void
+OVRWindow::resetInputLatencyHistogram() {
+    auto& histogram = _inputLatency.histogram;
+    histogram.binWidth = INPUT_LATENCY_BIN_WIDTH;
+    histogram.bins.fill(0, INPUT_LATENCY_BIN_COUNT);
+    histogram.count = 0;
+    histogram.mean = 0.0f;
+    histogram.minimum = 0.0f;
+    histogram.maximum = 0.0f;
+    _inputLatency.sum = 0.0;
+}
+
+
+OVRSensorSampler&
+OVRWindow::getSensorSampler() {
+    return *_sensorSampler;
+}
+
+
+const OVRWindow::ReconfigurationCounts&
+OVRWindow::getReconfigurationCounts() const {
+    return _reconfigurations;
+}
+
+
 const ovrHmdDesc&
 OVRWindow::getDeviceInfo() const {
     return _device;
@@ -227,292 +818,1939 @@ OVRWindow::enableFeature(const OVRWindow::Feature feature, const bool enable) {
 
 
 void
-OVRWindow::enableFeatures(const std::initializer_list<OVRWindow::Feature>& features, const bool enable) {
-    for (const auto& feature : features) {
-        enableFeature(feature, enable);
+OVRWindow::enableFeatures(const std::initializer_list<OVRWindow::Feature>& features, const bool enable) {
+    for (const auto& feature : features) {
+        enableFeature(feature, enable);
+    }
+}
+
+
+bool
+OVRWindow::isFeatureEnabled(const OVRWindow::Feature feature) const {
+    return _enabledFeatures.contains(feature);
+}
+
+
+bool
+OVRWindow::isFeatureSupported(const OVRWindow::Feature feature) const {
+    const auto& mask = static_cast<std::underlying_type<OVRWindow::Feature>::type>(feature);
+    switch (feature) {
+        // These features are not supported on all revisions of the Rift HMD.
+        case OVRWindow::Feature::PositionalTracking:
+        case OVRWindow::Feature::YawCorrection:
+            return (mask & _device.SensorCaps) == _device.SensorCaps;
+        default:
+            return true;
+    }
+}
+
+
+OVRWindow::Vision
+OVRWindow::getVision() const {
+    return _vision;
+}
+
+
+void
+OVRWindow::setVision(const OVRWindow::Vision vision) {
+    if (_vision != vision) {
+        _vision = vision;
+        _dirty.rendering = true;
+    }
+}
+
+
+void
+OVRWindow::toggleVision() {
+    setVision(_vision != OVRWindow::Vision::Binocular ? OVRWindow::Vision::Binocular : OVRWindow::Vision::Monocular);
+}
+
+
+OVRWindow::LOD
+OVRWindow::getLOD() const {
+    return _LOD;
+}
+
+
+void
+OVRWindow::setLOD(const OVRWindow::LOD lod) {
+    if (_LOD != lod) {
+        _LOD = lod;
+        _tracer.counter("LOD", static_cast<std::underlying_type<OVRWindow::LOD>::type>(_LOD));
+        changeLOD(_LOD);
+        emit LODChanged(_LOD);
+    }
+}
+
+
+void
+OVRWindow::changeLOD(const OVRWindow::LOD lod) {
+    const auto& profile = getLODProfile(lod);
+    const auto& unrestricted = [](const float tangent) {
+        return tangent > 0.0f ? tangent : std::numeric_limits<float>::max();
+    };
+    setPixelDensity(profile.pixelDensity);
+    clampFOV(unrestricted(profile.horizontalFOV), unrestricted(profile.verticalFOV));
+    enableMultisampling(profile.multisampling);
+    setDistortionMeshDecimation(profile.distortionMeshDecimation);
+    enableAlternateEyeRendering(profile.alternateEyes);
+    enableTemporalUpsampling(profile.temporalUpsampling);
+    for (auto it = profile.features.constBegin(); it != profile.features.constEnd(); ++it) {
+        enableFeature(it.key(), it.value());
+    }
+}
+
+
+const OVRWindow::LODProfile&
+OVRWindow::getLODProfile(const OVRWindow::LOD lod) const {
+    return _LODProfiles[static_cast<std::underlying_type<OVRWindow::LOD>::type>(lod)];
+}
+
+
+void
+OVRWindow::setLODProfile(const OVRWindow::LOD lod, const OVRWindow::LODProfile& profile) {
+    _LODProfiles[static_cast<std::underlying_type<OVRWindow::LOD>::type>(lod)] = profile;
+    if (_LOD == lod)
+        changeLOD(_LOD);
+}
+
+
+bool
+OVRWindow::loadLODProfiles(const QString& path) {
+    QFile file(path);
+    if (!file.open(QFile::ReadOnly))
+        return false;
+
+    QJsonParseError error;
+    const auto& document = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError || !document.isObject())
+        return false;
+
+    // The profiles are only replaced if every level in the file is valid.
+    auto profiles = _LODProfiles;
+    const auto& root = document.object();
+    for (int i = 0; i < profiles.size(); ++i) {
+        if (root.contains(LOD_NAMES[i])) {
+            const auto& level = root.value(LOD_NAMES[i]);
+            if (!level.isObject() || !parseLODProfile(level.toObject(), profiles[i]))
+                return false;
+        }
+    }
+    _LODProfiles = profiles;
+    changeLOD(_LOD);
+    return true;
+}
+
+
+void
+OVRWindow::reduceLOD() {
+    if (_LOD != OVRWindow::LOD::Lowest) {
+        setLOD(static_cast<OVRWindow::LOD>(static_cast<std::underlying_type<OVRWindow::LOD>::type>(_LOD) - 1));
+    }
+}
+
+
+void
+OVRWindow::increaseLOD() {
+    if (_LOD != OVRWindow::LOD::Highest) {
+        setLOD(static_cast<OVRWindow::LOD>(static_cast<std::underlying_type<OVRWindow::LOD>::type>(_LOD) + 1));
+    }
+}
+
+
+float
+OVRWindow::getIPD() const {
+    return ovrHmd_GetFloat(_device.Handle, OVR_KEY_IPD, OVR_DEFAULT_IPD);
+}
+
+
+void
+OVRWindow::setIPD(const float ipd) {
+    // If the IPD is changed, only the eyes' offsets need to be updated.
+    if (ovrHmd_SetFloat(_device.Handle, OVR_KEY_IPD, ipd))
+        _dirty.viewAdjust = true;
+}
+
+
+void
+OVRWindow::forceZeroIPD(const bool force) {
+    // If the IPD is changed, only the eyes' offsets need to be updated.
+    if (_forceZeroIPD != force) {
+        _forceZeroIPD = force;
+        _dirty.viewAdjust = true;
+    }
+}
+
+
+float
+OVRWindow::getPixelDensity() const {
+    return _pixelDensity;
+}
+
+
+void
+OVRWindow::setPixelDensity(const float density) {
+    // When the pixel density is changed, the render target needs to be resized.
+    if (_pixelDensity != density) {
+        _pixelDensity = density <= 0.0f ? 0.5f : density;
+        _dirty.renderTarget = true;
+    }
+}
+
+
+const ovrFovPort&
+OVRWindow::getFOV(const ovrEyeType eye) const {
+    return _FOV[eye];
+}
+
+
+void
+OVRWindow::setFOV(const ovrEyeType eye, const ovrFovPort& fov) {
+    // Each tangent is kept within the range the device's lenses can display.
+    const auto& maximum = _device.MaxEyeFov[eye];
+    const auto& clamp = [](const float tangent, const float maximum) {
+        return std::min(std::max(tangent, MINIMUM_FOV_TANGENT), maximum);
+    };
+    const ovrFovPort& clamped = {
+        clamp(fov.UpTan, maximum.UpTan),
+        clamp(fov.DownTan, maximum.DownTan),
+        clamp(fov.LeftTan, maximum.LeftTan),
+        clamp(fov.RightTan, maximum.RightTan)
+    };
+
+    // When the FOV is changed, the render target needs to be resized and the rendering
+    // configuration updated.
+    auto& current = _FOV[eye];
+    if (std::memcmp(&current, &clamped, sizeof(ovrFovPort)) != 0) {
+        current = clamped;
+        _dirty.renderTarget = true;
+        _dirty.rendering = true;
+        _distortion.dirty = true;
+    }
+}
+
+
+void
+OVRWindow::setFOV(const ovrFovPort& fov) {
+    // The right eye's FOV mirrors the left eye's.
+    setFOV(ovrEye_Left, fov);
+    setFOV(ovrEye_Right, {fov.UpTan, fov.DownTan, fov.RightTan, fov.LeftTan});
+}
+
+
+void
+OVRWindow::clampFOV(const float horizontal, const float vertical) {
+    for (unsigned int i = 0; i < ovrEye_Count; ++i) {
+        const auto& fov = _device.DefaultEyeFov[i];
+        setFOV(static_cast<ovrEyeType>(i), {
+            std::min(fov.UpTan, vertical),
+            std::min(fov.DownTan, vertical),
+            std::min(fov.LeftTan, horizontal),
+            std::min(fov.RightTan, horizontal)
+        });
+    }
+}
+
+
+void
+OVRWindow::resetFOV() {
+    for (unsigned int i = 0; i < ovrEye_Count; ++i) {
+        setFOV(static_cast<ovrEyeType>(i), _device.DefaultEyeFov[i]);
+    }
+}
+
+
+float
+OVRWindow::getNearClippingDistance() const {
+    return _nearClippingPlaneDistance;
+}
+
+
+void
+OVRWindow::setNearClippingDistance(const float near) {
+    if (_nearClippingPlaneDistance != near) {
+        _nearClippingPlaneDistance = near;
+        for (auto& dirty : _dirty.projections) {
+            dirty = true;
+        }
+    }
+}
+
+
+float
+OVRWindow::getFarClippingDistance() const {
+    return _farClippingPlaneDistance;
+}
+
+
+void
+OVRWindow::setFarClippingDistance(const float far) {
+    if (_farClippingPlaneDistance != far) {
+        _farClippingPlaneDistance = far;
+        for (auto& dirty : _dirty.projections) {
+            dirty = true;
+        }
+    }
+}
+
+
+bool
+OVRWindow::isMultisamplingEnabled() const {
+    return getOvrGlConfig().OGL.Header.Multisample == 1;
+}
+
+
+void
+OVRWindow::enableMultisampling(const bool enable) {
+    auto& multisample = getOvrGlConfig().OGL.Header.Multisample;
+    if (static_cast<bool>(multisample) != enable) {
+        multisample = enable ? 1 : 0;
+        _dirty.rendering = true;
+    }
+}
+
+
+void
+OVRWindow::toggleMultisampling() {
+    auto& multisample = getOvrGlConfig().OGL.Header.Multisample;
+    multisample = !multisample;
+    _dirty.rendering = true;
+}
+
+
+bool
+OVRWindow::isOffscreen() const {
+    return _offscreen.surface != nullptr;
+}
+
+
+void
+OVRWindow::renderOffscreen(const QVector<OVRWindow::OffscreenFrame>& frames) {
+    // The first time offscreen rendering is requested, create an offscreen surface
+    // that shares the window's format, and initialize the OpenGL context with it. If
+    // the window has already been shown, its context is used instead.
+    if (!hasValidGL()) {
+        _offscreen.surface.reset(new QOffscreenSurface(screen()));
+        _offscreen.surface->setFormat(requestedFormat());
+        _offscreen.surface->create();
+        assert(_offscreen.surface->isValid());
+        initializeContext();
+        doneCurrent();
+        emit initialized();
+    }
+    if (!_offscreen.started && !frames.isEmpty()) {
+        _offscreen.time = frames.first().time;
+        _offscreen.started = true;
+    }
+    makeCurrent();
+    for (int i = 0; i < frames.size(); ++i) {
+        const auto& frame = frames[i];
+        const auto& dt = static_cast<float>(frame.time - _offscreen.time);
+        _offscreen.time = frame.time;
+
+        // There is no display, so the frame is considered to be scanned out immediately.
+        ovrFrameTiming frameTiming = {};
+        frameTiming.DeltaSeconds = dt;
+        frameTiming.ThisFrameSeconds = frame.time;
+        frameTiming.TimewarpPointSeconds = frame.time;
+        frameTiming.NextFrameSeconds = frame.time;
+        frameTiming.ScanoutMidpointSeconds = frame.time;
+        frameTiming.EyeScanoutSeconds[ovrEye_Left] = frame.time;
+        frameTiming.EyeScanoutSeconds[ovrEye_Right] = frame.time;
+
+        const Annotation annotation(isAnnotating(), _tracer, "Frame");
+        collectGPUTimers();
+
+        // The head pose is supplied by the caller so the device (and its sensor)
+        // does not need to be configured.
+        _glState.beginFrame();
+        sanitizeRenderTargetConfiguration();
+        sanitizeRenderingConfiguration();
+        sanitizeHUD(frame.time);
+        synchronizeFrameUpdate(dt, frameTiming);
+        acquireFrameSlot();
+        sanitizeTransformBuffer();
+
+        _glState.bindFramebuffer(_renderTarget.fbo);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        for (const auto& eye : _device.EyeRenderOrder) {
+            beginEyePass(eye);
+            paintEye(eye, frame.pose, dt);
+            endEyePass(eye);
+        }
+        emit offscreenFrameRendered(static_cast<unsigned int>(i));
+        _glState.bindFramebuffer(0);
+        releaseFrameSlot();
+
+        // The frame's time is chosen by the caller, so the latency is measured against
+        // the time at which the frame is finished.
+        measureInputLatency(ovr_GetTimeInSeconds());
+    }
+    doneCurrent();
+}
+
+
+QImage
+OVRWindow::grabRenderTarget() {
+    assert(QOpenGLContext::currentContext() == &_gl);
+
+    // Note that QImage's scanlines are 32-bit aligned, which matches OpenGL's default
+    // pack alignment. OpenGL's origin is at the bottom-left corner so the image is
+    // flipped vertically before being returned.
+    const auto& resolution = _renderTarget.resolution;
+    QImage image(resolution, QImage::Format_RGB888);
+    _glState.bindFramebuffer(_renderTarget.fbo);
+    glReadPixels(0, 0, resolution.width(), resolution.height(), GL_RGB, GL_UNSIGNED_BYTE, image.bits());
+    return image.mirrored();
+}
+
+
+bool
+OVRWindow::isHUDEnabled() const {
+    return _HUD.enabled;
+}
+
+
+void
+OVRWindow::enableHUD(const bool enable) {
+    if (_HUD.enabled != enable) {
+        _HUD.enabled = enable;
+        _HUD.dirty = true;
+    }
+}
+
+
+const QSize&
+OVRWindow::getHUDResolution() const {
+    return _HUD.resolution;
+}
+
+
+void
+OVRWindow::setHUDResolution(const QSize& resolution) {
+    if (_HUD.resolution != resolution && !resolution.isEmpty()) {
+        _HUD.resolution = resolution;
+        _HUD.dirty = true;
+    }
+}
+
+
+float
+OVRWindow::getHUDRefreshInterval() const {
+    return _HUD.refreshInterval;
+}
+
+
+void
+OVRWindow::setHUDRefreshInterval(const float interval) {
+    _HUD.refreshInterval = std::max(interval, 0.0f);
+}
+
+
+void
+OVRWindow::updateHUD() {
+    _HUD.dirty = true;
+}
+
+
+bool
+OVRWindow::isReprojectionEnabled() const {
+    return _reprojection.enabled;
+}
+
+
+void
+OVRWindow::enableReprojection(const bool enable) {
+    if (_reprojection.enabled != enable) {
+        _reprojection.enabled = enable;
+        _reprojection.valid = false;
+        _idle.valid = false;
+
+        // The render target's history buffer may need to be allocated.
+        _dirty.renderTarget = true;
+    }
+}
+
+
+float
+OVRWindow::getFrameTimeBudget() const {
+    return _reprojection.budget;
+}
+
+
+void
+OVRWindow::setFrameTimeBudget(const float budget) {
+    _reprojection.budget = std::max(budget, 0.0f);
+}
+
+
+unsigned int
+OVRWindow::getReprojectedFrameCount() const {
+    return _reprojection.count;
+}
+
+
+bool
+OVRWindow::isAlternateEyeRenderingEnabled() const {
+    return _alternateEye.enabled;
+}
+
+
+void
+OVRWindow::enableAlternateEyeRendering(const bool enable) {
+    if (_alternateEye.enabled != enable) {
+        _alternateEye.enabled = enable;
+
+        // The history buffer may be stale, or may need to be allocated.
+        _reprojection.valid = false;
+        _dirty.renderTarget = true;
+    }
+}
+
+
+bool
+OVRWindow::isTemporalUpsamplingEnabled() const {
+    return _upsampling.enabled;
+}
+
+
+void
+OVRWindow::enableTemporalUpsampling(const bool enable) {
+    if (_upsampling.enabled != enable) {
+        _upsampling.enabled = enable;
+        _upsampling.valid = false;
+    }
+}
+
+
+bool
+OVRWindow::isAsynchronousUpdateEnabled() const {
+    return _update.asynchronous;
+}
+
+
+void
+OVRWindow::enableAsynchronousUpdate(const bool enable) {
+    _update.asynchronous = enable;
+}
+
+
+bool
+OVRWindow::isTransformBufferEnabled() const {
+    return _transformBuffer.enabled;
+}
+
+
+void
+OVRWindow::enableTransformBuffer(const bool enable) {
+    _transformBuffer.enabled = enable;
+}
+
+
+void
+OVRWindow::bindTransformBlock(const GLuint program, const char* const name) {
+    const auto& index = glGetUniformBlockIndex(program, name);
+    if (index != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, index, OVRWindow::TransformBufferBinding);
+}
+
+
+unsigned int
+OVRWindow::getMaximumFramesInFlight() const {
+    return _frames.maximum;
+}
+
+
+void
+OVRWindow::setMaximumFramesInFlight(const unsigned int maximum) {
+    _frames.maximum = std::min(std::max(maximum, 1u), OVRWindow::FrameSlotCount);
+}
+
+
+unsigned int
+OVRWindow::getFrameSlot() const {
+    return _frames.index % OVRWindow::FrameSlotCount;
+}
+
+
+bool
+OVRWindow::isClientDistortionEnabled() const {
+    return _distortion.enabled;
+}
+
+
+void
+OVRWindow::enableClientDistortion(const bool enable) {
+    if (_distortion.enabled != enable) {
+        _distortion.enabled = enable;
+        _dirty.rendering = true;
+    }
+}
+
+
+unsigned int
+OVRWindow::getDistortionMeshDecimation() const {
+    return _distortion.decimation;
+}
+
+
+void
+OVRWindow::setDistortionMeshDecimation(const unsigned int decimation) {
+    const auto& clamped = std::max(decimation, 1u);
+    if (_distortion.decimation != clamped) {
+        _distortion.decimation = clamped;
+        _distortion.dirty = true;
+    }
+}
+
+
+bool
+OVRWindow::isIdleModeEnabled() const {
+    return _idle.enabled;
+}
+
+
+void
+OVRWindow::enableIdleMode(const bool enable) {
+    _idle.enabled = enable;
+}
+
+
+float
+OVRWindow::getIdleThreshold() const {
+    return _idle.threshold;
+}
+
+
+void
+OVRWindow::setIdleThreshold(const float threshold) {
+    _idle.threshold = std::max(threshold, 0.0f);
+}
+
+
+bool
+OVRWindow::isSceneClean() const {
+    return _idle.sceneClean;
+}
+
+
+void
+OVRWindow::markSceneClean(const bool clean) {
+    _idle.sceneClean = clean;
+}
+
+
+unsigned int
+OVRWindow::getReusedFrameCount() const {
+    return _idle.count;
+}
+
+
+bool
+OVRWindow::isFrameExportEnabled() const {
+    return _export.enabled;
+}
+
+
+void
+OVRWindow::enableFrameExport(const bool enable, const QString& name, const OVRWindow::FrameExportSource source) {
+    // The ring is recreated with the new name when the next frame is exported.
+    if (!enable || name != _export.name)
+        _export.exporter.reset();
+
+    _export.enabled = enable;
+    _export.failed = false;
+    _export.name = name;
+    _export.source = source;
+    _export.pending.fill(false);
+}
+
+
+bool
+OVRWindow::hasFrameExportFailed() const {
+    return _export.failed;
+}
+
+
+unsigned long long
+OVRWindow::getExportedFrameCount() const {
+    return _export.count;
+}
+
+
+void
+OVRWindow::updateGL() {
+    if (isExposed() && hasValidGL()) {
+        makeCurrent();
+        paintGL();
+        doneCurrent();
+        requestUpdateGL();
+    }
+}
+
+
+void
+OVRWindow::requestUpdateGL()
+{
+    if (!_pendingUpdateRequest) {
+        _pendingUpdateRequest = true;
+        QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateRequest));
+    }
+}
+
+
+void
+OVRWindow::configureGL() {
+    auto& OGL = getOvrGlConfig().OGL;
+
+    OGL.Header.API = ovrRenderAPI_OpenGL;
+    OGL.Header.RTSize.w = _device.Resolution.w;
+    OGL.Header.RTSize.h = _device.Resolution.h;
+    OGL.Header.Multisample = 0;
+#if defined(Q_OS_LINUX)
+    OGL.Disp = getXDisplay(this);
+    OGL.Win = static_cast<::Window>(winId());
+    assert(OGL.Disp != nullptr);
+#elif defined(Q_OS_WIN32)
+    __OVR_GL_CONFIG.Window = static_cast<::HWND>(winId());
+#endif
+    _dirty.rendering = true;
+}
+
+
+void
+OVRWindow::paintGL() {
+    const Annotation annotation(isAnnotating(), _tracer, "Frame");
+    collectGPUTimers();
+
+    // Update all configurations before drawing the frame.
+    _glState.beginFrame();
+    sanitizeRenderTargetConfiguration();
+    sanitizeUpsampling();
+    sanitizeDeviceConfiguration();
+    sanitizeRenderingConfiguration();
+    sanitizeDistortionMeshes();
+    sanitizeHUD(ovr_GetTimeInSeconds());
+
+    const auto& hmd = _device.Handle;
+    const auto& frameTiming = _distortion.enabled ? ovrHmd_BeginFrameTiming(hmd, 0) : ovrHmd_BeginFrame(hmd, 0);
+    const auto& dt = frameTiming.DeltaSeconds;
+
+    // The frame must be rendered before the frame time budget runs out or, if there is
+    // no budget, before the SDK starts its distortion pass.
+    const auto& deadline = _reprojection.budget > 0.0f ?
+        ovr_GetTimeInSeconds() + _reprojection.budget :
+        (isFeatureEnabled(OVRWindow::Feature::Timewarp) ? frameTiming.TimewarpPointSeconds : frameTiming.NextFrameSeconds);
+
+    // The frame is prepared while the GPU executes the previous ones, but no more than the
+    // maximum number of frames may be in flight.
+    synchronizeFrameUpdate(dt, frameTiming);
+    acquireFrameSlot();
+    publishExportedFrame();
+    sanitizeTransformBuffer();
+
+    _glState.bindFramebuffer(_renderTarget.fbo);
+
+    bool isReprojected = false;
+    bool isAlternated = false;
+    bool isReused = false;
+    _latency.sampleTime = ovr_GetTimeInSeconds();
+    for (const auto& eye : _device.EyeRenderOrder) {
+        const auto& pose = _distortion.enabled ? ovrHmd_GetEyePose(hmd, eye) : ovrHmd_BeginEyeRender(hmd, eye);
+
+        // Whether the previous frame is reused is decided with the first eye's pose, before
+        // the render target is cleared.
+        if (eye == _device.EyeRenderOrder[0]) {
+            isReused = isFrameReusable(pose);
+            if (isReused)
+                reuseFrame();
+            else
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
+        if (!isReused) {
+            beginEyePass(eye);
+            if (isEyeAlternated(eye)) {
+                reprojectEye(eye, pose);
+                isAlternated = true;
+            } else if (isReprojectionRequired(eye, deadline)) {
+                reprojectEye(eye, pose);
+                isReprojected = true;
+            } else {
+                const auto& start = ovr_GetTimeInSeconds();
+                paintEye(eye, pose, dt);
+                _reprojection.reprojected[eye] = false;
+                _reprojection.paintDuration[eye] = ovr_GetTimeInSeconds() - start;
+            }
+            _reprojection.poses[eye] = pose;
+            endEyePass(eye);
+        }
+
+        // A reused eye buffer is submitted with the pose it was rendered with, so that
+        // timewarp corrects the head's (small) motion since.
+        const auto& renderPose = _reprojection.poses[eye];
+        _distortion.poses[eye] = renderPose;
+        if (_upsampling.active && !isReused)
+            upsampleEye(eye, renderPose);
+        if (!_distortion.enabled)
+            ovrHmd_EndEyeRender(hmd, eye, renderPose, &getSubmittedOvrGlTexture(eye).Texture);
+    }
+    _glState.bindFramebuffer(0);
+
+    // Update the next frame while this one is being finished.
+    if (_update.asynchronous) {
+        beginJobFrame();
+        _update.job = _jobs.run("updateFrame", [this, dt, frameTiming]() {
+            updateFrame(dt, frameTiming);
+        });
+    }
+    {
+        const Annotation annotation(isAnnotating(), _tracer, "Distortion");
+        if (_distortion.enabled) {
+            renderDistortion(frameTiming);
+            readBackExportedFrame(frameTiming);
+            _gl.swapBuffers(this);
+            ovrHmd_EndFrameTiming(hmd);
+        } else {
+            // ovrHmd_EndFrame does not clean up after itself, so the state it may have
+            // changed is invalidated, and set again when the scope is left.
+            readBackExportedFrame(frameTiming);
+            const OVRGLState::Scope scope(_glState);
+            ovrHmd_EndFrame(hmd);
+            _glState.invalidate();
+        }
+    }
+    releaseFrameSlot();
+    measureLatency(frameTiming);
+    measureInputLatency(frameTiming.ScanoutMidpointSeconds);
+
+    // Keep the frame's eye buffers so they can be reprojected during the next frame. A
+    // reused frame is already in the pixel buffer.
+    if (isRenderTargetHistoryRequired() && !isReused) {
+        swapRenderTargetHistory();
+        _reprojection.valid = true;
+        if (isReprojected)
+            ++_reprojection.count;
+    }
+    if (!isReused)
+        _alternateEye.eye = _alternateEye.eye == ovrEye_Left ? ovrEye_Right : ovrEye_Left;
+
+    // The output buffer that was just written now holds the most recent output. The
+    // jitter is only applied to the transforms of frames that are upsampled.
+    if (_upsampling.active && !isReused) {
+        _upsampling.current = 1 - _upsampling.current;
+        _upsampling.valid = true;
+    }
+    _upsampling.active = false;
+    _idle.reused = isReused;
+    _idle.valid = !isReprojected && !isAlternated;
+}
+
+
+void
+OVRWindow::acquireFrameSlot() {
+    // Wait until the GPU has finished the frames that would exceed the maximum number of
+    // frames in flight, oldest first. The frame that last used the slot is always one of them.
+    ++_frames.index;
+    for (auto i = OVRWindow::FrameSlotCount; i >= _frames.maximum; --i) {
+        auto& fence = _frames.fences[(_frames.index + OVRWindow::FrameSlotCount - i) % OVRWindow::FrameSlotCount];
+        if (fence != nullptr) {
+            const Annotation annotation(isAnnotating(), _tracer, "Wait for frame");
+            while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {}
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+}
+
+
+void
+OVRWindow::releaseFrameSlot() {
+    auto& fence = _frames.fences[getFrameSlot()];
+    assert(fence == nullptr);
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+
+void
+OVRWindow::readBackExportedFrame(const ovrFrameTiming& frameTiming) {
+    if (!_export.enabled || _export.failed)
+        return;
+
+    const Annotation annotation(isAnnotating(), _tracer, "Read back exported frame");
+    if (_export.buffers[0] == 0)
+        glGenBuffers(static_cast<GLsizei>(_export.buffers.size()), _export.buffers.data());
+
+    // The mirrored output is only in the default framebuffer before the SDK's distortion
+    // pass swaps buffers, so it cannot be read back in SDK distortion mode.
+    const bool isMirror = _export.source == OVRWindow::FrameExportSource::Mirror;
+    if (isMirror && !_distortion.enabled) {
+        _export.failed = true;
+        return;
     }
+
+    // The eye buffers are read back from the texture submitted to the SDK, which is the
+    // upsampled output, and larger than the render target, when upsampling is active.
+    // Both eyes are submitted in the same texture.
+    const auto& submitted = getSubmittedOvrGlTexture(ovrEye_Left).OGL;
+    auto fbo = _renderTarget.fbo;
+    if (_upsampling.active)
+        fbo = _upsampling.fbos[submitted.TexId == _upsampling.textures[0] ? 0 : 1];
+    const auto& RTSize = getOvrGlConfig().OGL.Header.RTSize;
+    const auto& TextureSize = submitted.Header.TextureSize;
+    const auto& resolution = isMirror ? QSize(RTSize.w, RTSize.h) : QSize(TextureSize.w, TextureSize.h);
+    const auto& width = static_cast<std::uint32_t>(resolution.width());
+    const auto& height = static_cast<std::uint32_t>(resolution.height());
+
+    // The pixels are read asynchronously into the slot's pixel buffer, which is mapped
+    // once the GPU is done with the frame (see publishExportedFrame).
+    const auto& slot = getFrameSlot();
+    auto& frame = _export.frames[slot];
+    frame = {_frames.index, frameTiming.ScanoutMidpointSeconds, OVRFrameExporter::Format::RGBA8, width, height, 4 * width, {}};
+    for (unsigned int i = 0; i < ovrEye_Count; ++i) {
+        const auto& pose = _distortion.poses[i];
+        frame.poses[i] = {
+            {pose.Orientation.x, pose.Orientation.y, pose.Orientation.z, pose.Orientation.w},
+            {pose.Position.x, pose.Position.y, pose.Position.z},
+        };
+    }
+    _glState.bindFramebuffer(isMirror ? 0 : fbo);
+    _glState.bindBuffer(GL_PIXEL_PACK_BUFFER, _export.buffers[slot]);
+    glBufferData(GL_PIXEL_PACK_BUFFER, frame.stride * frame.height, nullptr, GL_STREAM_READ);
+    glReadPixels(0, 0, resolution.width(), resolution.height(), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    _glState.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    _glState.bindFramebuffer(0);
+    _export.pending[slot] = true;
 }
 
 
-bool
-OVRWindow::isFeatureEnabled(const OVRWindow::Feature feature) const {
-    return _enabledFeatures.contains(feature);
+void
+OVRWindow::publishExportedFrame() {
+    const auto& slot = getFrameSlot();
+    if (!_export.enabled || !_export.pending[slot])
+        return;
+
+    // The GPU has finished the frame that last used the slot (see acquireFrameSlot), so
+    // mapping its pixel buffer does not stall.
+    const Annotation annotation(isAnnotating(), _tracer, "Publish exported frame");
+    const auto& frame = _export.frames[slot];
+    const auto& size = static_cast<std::size_t>(frame.stride) * frame.height;
+    if (_export.exporter == nullptr || _export.exporter->getCapacity() < size) {
+        // The previous ring is unlinked when it is destroyed, so it must be destroyed
+        // before its replacement, which has the same name, is created.
+        _export.exporter.reset();
+        _export.exporter.reset(new OVRFrameExporter(_export.name, EXPORT_RING_SIZE, size));
+        if (!_export.exporter->isOpen()) {
+            _export.exporter.reset();
+            _export.failed = true;
+            _export.pending.fill(false);
+            return;
+        }
+    }
+
+    _glState.bindBuffer(GL_PIXEL_PACK_BUFFER, _export.buffers[slot]);
+    const auto* const pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+    if (pixels != nullptr && _export.exporter->write(frame, pixels))
+        ++_export.count;
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    _glState.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    _export.pending[slot] = false;
 }
 
 
-bool
-OVRWindow::isFeatureSupported(const OVRWindow::Feature feature) const {
-    const auto& mask = static_cast<std::underlying_type<OVRWindow::Feature>::type>(feature);
-    switch (feature) {
-        // These features are not supported on all revisions of the Rift HMD.
-        case OVRWindow::Feature::PositionalTracking:
-        case OVRWindow::Feature::YawCorrection:
-            return (mask & _device.SensorCaps) == _device.SensorCaps;
-        default:
-            return true;
+void
+OVRWindow::sanitizeTransformBuffer() {
+    if (!_transformBuffer.enabled || _transformBuffer.buffer != 0)
+        return;
+
+    // Each eye's uniform block must be aligned to the implementation's offset alignment.
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    alignment = std::max(alignment, 1);
+    _transformBuffer.stride = ((TRANSFORM_BLOCK_SIZE + alignment - 1) / alignment) * alignment;
+
+    glGenBuffers(1, &_transformBuffer.buffer);
+    assert(_transformBuffer.buffer != 0);
+    glBindBuffer(GL_UNIFORM_BUFFER, _transformBuffer.buffer);
+    labelObject(GL_BUFFER, _transformBuffer.buffer, "OVRWindow transform buffer");
+
+    // Map the buffer persistently if the implementation supports it.
+    const auto& size = OVRWindow::FrameSlotCount * ovrEye_Count * _transformBuffer.stride;
+    const auto& format = _gl.format();
+    const auto& version = 10 * format.majorVersion() + format.minorVersion();
+    if (version >= 44 || _gl.hasExtension("GL_ARB_buffer_storage")) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_UNIFORM_BUFFER, size, nullptr, flags);
+        _transformBuffer.mapping = static_cast<GLubyte*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, size, flags));
+        assert(_transformBuffer.mapping != nullptr);
+    } else {
+        glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_STREAM_DRAW);
     }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
 
-OVRWindow::Vision
-OVRWindow::getVision() const {
-    return _vision;
+void
+OVRWindow::publishTransforms(const ovrEyeType eye, const OVRWindow::RenderTransforms& transforms) {
+    if (!_transformBuffer.enabled)
+        return;
+
+    // Note that QMatrix4x4 stores its values in column-major order, as does std140.
+    const auto& viewProjection = transforms.perspective * transforms.view;
+    const QMatrix4x4* const matrices[] = {&transforms.view, &transforms.perspective, &viewProjection, &transforms.ortho};
+    GLfloat block[4 * 16];
+    for (unsigned int i = 0; i < 4; ++i) {
+        std::copy(matrices[i]->constData(), matrices[i]->constData() + 16, block + 16 * i);
+    }
+
+    const auto& offset = (getFrameSlot() * ovrEye_Count + eye) * _transformBuffer.stride;
+    if (_transformBuffer.mapping != nullptr) {
+        std::copy(block, block + 4 * 16, reinterpret_cast<GLfloat*>(_transformBuffer.mapping + offset));
+        glBindBufferRange(GL_UNIFORM_BUFFER, OVRWindow::TransformBufferBinding, _transformBuffer.buffer, offset, TRANSFORM_BLOCK_SIZE);
+    } else {
+        glBindBufferRange(GL_UNIFORM_BUFFER, OVRWindow::TransformBufferBinding, _transformBuffer.buffer, offset, TRANSFORM_BLOCK_SIZE);
+        glBufferSubData(GL_UNIFORM_BUFFER, offset, TRANSFORM_BLOCK_SIZE, block);
+    }
 }
 
 
 void
-OVRWindow::setVision(const OVRWindow::Vision vision) {
-    if (_vision != vision) {
-        _vision = vision;
-        _dirty.rendering = true;
+OVRWindow::sanitizeDistortionMeshes() {
+    if (!_distortion.enabled || !_distortion.dirty)
+        return;
+
+    const Annotation annotation(isAnnotating(), _tracer, "sanitizeDistortionMeshes");
+
+    // Initialize the shader program, the buffers and the sampler used to correct distortion.
+    // Each vertex's texture coordinates are tangents of the eye's view angles, which are
+    // rotated by the timewarp matrices (or identity matrices) before being mapped to the
+    // eye's viewport in the render target.
+    if (!_distortion.program) {
+        static const char* const VERTEX_SHADER =
+            "#version 120\n"
+            "attribute vec2 position;\n"
+            "attribute vec2 factors;\n"
+            "attribute vec2 tangentR;\n"
+            "attribute vec2 tangentG;\n"
+            "attribute vec2 tangentB;\n"
+            "uniform vec2 uvScale;\n"
+            "uniform vec2 uvOffset;\n"
+            "uniform mat4 rotationStart;\n"
+            "uniform mat4 rotationEnd;\n"
+            "varying vec2 uvR;\n"
+            "varying vec2 uvG;\n"
+            "varying vec2 uvB;\n"
+            "varying float vignette;\n"
+            "vec2 timewarp(vec2 tangent, mat4 rotation) {\n"
+            "    vec3 direction = (rotation * vec4(tangent, 1.0, 1.0)).xyz;\n"
+            "    return uvScale * (direction.xy / direction.z) + uvOffset;\n"
+            "}\n"
+            "void main() {\n"
+            "    mat4 rotation = rotationStart + factors.x * (rotationEnd - rotationStart);\n"
+            "    uvR = timewarp(tangentR, rotation);\n"
+            "    uvG = timewarp(tangentG, rotation);\n"
+            "    uvB = timewarp(tangentB, rotation);\n"
+            "    vignette = factors.y;\n"
+            "    gl_Position = vec4(position, 0.5, 1.0);\n"
+            "}\n";
+        static const char* const FRAGMENT_SHADER =
+            "#version 120\n"
+            "uniform sampler2D source;\n"
+            "uniform bool chromatic;\n"
+            "uniform bool vignetting;\n"
+            "varying vec2 uvR;\n"
+            "varying vec2 uvG;\n"
+            "varying vec2 uvB;\n"
+            "varying float vignette;\n"
+            "void main() {\n"
+            "    vec3 color = texture2D(source, uvG).rgb;\n"
+            "    if (chromatic) {\n"
+            "        color.r = texture2D(source, uvR).r;\n"
+            "        color.b = texture2D(source, uvB).b;\n"
+            "    }\n"
+            "    gl_FragColor = vec4(vignetting ? color * vignette : color, 1.0);\n"
+            "}\n";
+        _distortion.program.reset(new QOpenGLShaderProgram);
+        auto& program = *_distortion.program;
+        program.addShaderFromSourceCode(QOpenGLShader::Vertex, VERTEX_SHADER);
+        program.addShaderFromSourceCode(QOpenGLShader::Fragment, FRAGMENT_SHADER);
+        program.bindAttributeLocation("position", 0);
+        program.bindAttributeLocation("factors", 1);
+        program.bindAttributeLocation("tangentR", 2);
+        program.bindAttributeLocation("tangentG", 3);
+        program.bindAttributeLocation("tangentB", 4);
+        const auto result = program.link();
+        assert(result);
+
+        glGenBuffers(ovrEye_Count, _distortion.vbo.data());
+        glGenBuffers(ovrEye_Count, _distortion.ibo.data());
+        assert(_distortion.vbo[ovrEye_Left] != 0 && _distortion.vbo[ovrEye_Right] != 0);
+        assert(_distortion.ibo[ovrEye_Left] != 0 && _distortion.ibo[ovrEye_Right] != 0);
+
+        // The render target's pixel buffer is sampled with nearest filtering elsewhere,
+        // but distortion correction requires bilinear filtering.
+        glGenSamplers(1, &_distortion.sampler);
+        assert(_distortion.sampler != 0);
+        glSamplerParameteri(_distortion.sampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glSamplerParameteri(_distortion.sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glSamplerParameteri(_distortion.sampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glSamplerParameteri(_distortion.sampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    // The meshes are always built with every correction the device supports, since the
+    // corrections that are applied are selected by the shader.
+    const auto& caps = _device.DistortionCaps & (ovrDistortionCap_Chromatic | ovrDistortionCap_TimeWarp | ovrDistortionCap_Vignette);
+    for (unsigned int i = 0; i < ovrEye_Count; ++i) {
+        const auto& eye = static_cast<ovrEyeType>(i);
+        ovrDistortionMesh mesh;
+        const auto result = ovrHmd_CreateDistortionMesh(_device.Handle, eye, _FOV[i], caps, &mesh);
+        assert(result);
+
+        const auto& indices = decimateDistortionMesh(mesh, _distortion.decimation);
+        _glState.bindBuffer(GL_ARRAY_BUFFER, _distortion.vbo[i]);
+        glBufferData(GL_ARRAY_BUFFER, mesh.VertexCount * sizeof(ovrDistortionVertex), mesh.pVertexData, GL_STATIC_DRAW);
+        _glState.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _distortion.ibo[i]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned short), indices.constData(), GL_STATIC_DRAW);
+        _distortion.indexCount[i] = indices.size();
+        ovrHmd_DestroyDistortionMesh(&mesh);
+
+        labelObject(GL_BUFFER, _distortion.vbo[i], "OVRWindow distortion mesh");
+        labelObject(GL_BUFFER, _distortion.ibo[i], "OVRWindow distortion mesh indices");
     }
+    _glState.bindBuffer(GL_ARRAY_BUFFER, 0);
+    _glState.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    // Mark the meshes as sanitized.
+    _distortion.dirty = false;
 }
 
 
 void
-OVRWindow::toggleVision() {
-    setVision(_vision != OVRWindow::Vision::Binocular ? OVRWindow::Vision::Binocular : OVRWindow::Vision::Monocular);
+OVRWindow::renderDistortion(const ovrFrameTiming& frameTiming) {
+    const OVRGLState::Scope scope(_glState);
+    const auto& hmd = _device.Handle;
+
+    // The head's orientation is sampled for timewarp as late as possible.
+    const bool timewarp = isFeatureEnabled(OVRWindow::Feature::Timewarp);
+    if (timewarp)
+        ovr_WaitTillTime(frameTiming.TimewarpPointSeconds);
+
+    // The application's clear color is kept since it is not tracked.
+    GLfloat clearColor[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+
+    const auto& resolution = getOvrGlConfig().OGL.Header.RTSize;
+    _glState.bindFramebuffer(0);
+    _glState.setViewport(0, 0, resolution.w, resolution.h);
+    _glState.setCapability(GL_DEPTH_TEST, false);
+    _glState.setCapability(GL_CULL_FACE, false);
+    _glState.setCapability(GL_SCISSOR_TEST, false);
+    _glState.setCapability(GL_STENCIL_TEST, false);
+    _glState.setCapability(GL_BLEND, false);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    _glState.setActiveTexture(GL_TEXTURE0);
+    glBindSampler(0, _distortion.sampler);
+
+    auto& program = *_distortion.program;
+    _glState.useProgram(program.programId());
+    program.setUniformValue("source", 0);
+    program.setUniformValue("chromatic", isFeatureEnabled(OVRWindow::Feature::ChromaticAberrationCorrection));
+    program.setUniformValue("vignetting", isFeatureEnabled(OVRWindow::Feature::Vignette));
+
+    bindVertexArray();
+    for (unsigned int i = 0; i < ovrEye_Count; ++i) {
+        const auto& eye = static_cast<ovrEyeType>(i);
+        const auto& ogl = getSubmittedOvrGlTexture(eye).OGL;
+        const auto& header = ogl.Header;
+        _glState.bindTexture(ogl.TexId);
+
+        // OpenGL's texture origin is at the bottom-left corner, so the scale and offset
+        // computed by the SDK are flipped vertically.
+        ovrVector2f scaleAndOffset[2];
+        ovrHmd_GetRenderScaleAndOffset(_renderInfo[i].Fov, header.TextureSize, header.RenderViewport, scaleAndOffset);
+        program.setUniformValue("uvScale", scaleAndOffset[0].x, -scaleAndOffset[0].y);
+        program.setUniformValue("uvOffset", scaleAndOffset[1].x, 1.0f - scaleAndOffset[1].y);
+
+        // Note that ovrMatrix4f is stored in row-major order, as expected by QMatrix4x4.
+        QMatrix4x4 rotations[2];
+        if (timewarp) {
+            ovrMatrix4f matrices[2];
+            ovrHmd_GetEyeTimewarpMatrices(hmd, eye, _distortion.poses[i], matrices);
+            rotations[0] = QMatrix4x4(&matrices[0].M[0][0]);
+            rotations[1] = QMatrix4x4(&matrices[1].M[0][0]);
+        }
+        program.setUniformValue("rotationStart", rotations[0]);
+        program.setUniformValue("rotationEnd", rotations[1]);
+
+        const auto& stride = static_cast<GLsizei>(sizeof(ovrDistortionVertex));
+        _glState.bindBuffer(GL_ARRAY_BUFFER, _distortion.vbo[i]);
+        _glState.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _distortion.ibo[i]);
+        for (GLuint attribute = 0; attribute < 5; ++attribute) {
+            glEnableVertexAttribArray(attribute);
+        }
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const GLvoid*>(offsetof(ovrDistortionVertex, Pos)));
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const GLvoid*>(offsetof(ovrDistortionVertex, TimeWarpFactor)));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const GLvoid*>(offsetof(ovrDistortionVertex, TexR)));
+        glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const GLvoid*>(offsetof(ovrDistortionVertex, TexG)));
+        glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const GLvoid*>(offsetof(ovrDistortionVertex, TexB)));
+        glDrawElements(GL_TRIANGLES, _distortion.indexCount[i], GL_UNSIGNED_SHORT, nullptr);
+    }
+    for (GLuint attribute = 0; attribute < 5; ++attribute) {
+        glDisableVertexAttribArray(attribute);
+    }
+    glBindSampler(0, 0);
+
+    // The SDK no longer draws the latency tester's quad, so it is flashed in front of
+    // the left lens, where the tester is placed, whenever the SDK requests it.
+    unsigned char color[3];
+    if (ovrHmd_ProcessLatencyTest(hmd, color)) {
+        GLint scissor[4];
+        glGetIntegerv(GL_SCISSOR_BOX, scissor);
+        _glState.setCapability(GL_SCISSOR_TEST, true);
+        glScissor((resolution.w - LATENCY_TEST_QUAD_SIZE) / 4, (resolution.h - LATENCY_TEST_QUAD_SIZE) / 2, LATENCY_TEST_QUAD_SIZE, LATENCY_TEST_QUAD_SIZE);
+        glClearColor(color[0] / 255.0f, color[1] / 255.0f, color[2] / 255.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glScissor(scissor[0], scissor[1], scissor[2], scissor[3]);
+    }
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
 }
 
 
-OVRWindow::LOD
-OVRWindow::getLOD() const {
-    return _LOD;
+bool
+OVRWindow::isFrameReusable(const ovrPosef& pose) const {
+    const auto& eye = _device.EyeRenderOrder[0];
+    return
+        _idle.enabled &&
+        _idle.sceneClean &&
+        _idle.valid &&
+        !_dirty.projections[ovrEye_Left] &&
+        !_dirty.projections[ovrEye_Right] &&
+        getPoseDelta(_reprojection.poses[eye], pose) < _idle.threshold;
 }
 
 
 void
-OVRWindow::setLOD(const OVRWindow::LOD lod) {
-    if (_LOD != lod) {
-        _LOD = lod;
-        changeLOD(_LOD);
-        emit LODChanged(_LOD);
-    }
+OVRWindow::reuseFrame() {
+    // If the previous frame was rendered, its eye buffers were moved to the history buffer.
+    if (isRenderTargetHistoryRequired() && !_idle.reused)
+        swapRenderTargetHistory();
+
+    // The history buffer no longer holds the previous frame.
+    _reprojection.valid = false;
+    ++_idle.count;
+    _tracer.instant("Frame reused");
 }
 
 
 void
-OVRWindow::changeLOD(const OVRWindow::LOD lod) {
-    // Reset enabled features.
-    _enabledFeatures.clear();
-
-    QSet<OVRWindow::Feature> features;
-    switch (lod)
-    {
-        case OVRWindow::LOD::Highest:
-            setPixelDensity(1.5f);
-        break;
-        case OVRWindow::LOD::High:
-            setPixelDensity(1.0f);
-        break;
-        case OVRWindow::LOD::Medium:
-            setPixelDensity(1.0f);
-        break;
-        case OVRWindow::LOD::Low:
-            setPixelDensity(0.5f);
-            enableMultisampling(false);
-        break;
-        case OVRWindow::LOD::Lowest:
-            setPixelDensity(0.25f);
-            enableMultisampling(false);
-        break;
-        default:
-            assert(false);
-        break;
-    }
-    // Enable the new feature set.
-    for (const auto& feature : features) {
-        enableFeature(feature, true);
+OVRWindow::beginJobFrame() {
+    _jobs.beginFrame();
+    if (_tracer.isTracing()) {
+        for (const auto& timing : _jobs.getTimings()) {
+            _tracer.complete(timing.name, timing.start, timing.end - timing.start, JOB_TRACE_THREAD + static_cast<int>(timing.thread));
+        }
     }
 }
 
 
 void
-OVRWindow::reduceLOD() {
-    if (_LOD != OVRWindow::LOD::Lowest) {
-        setLOD(static_cast<OVRWindow::LOD>(static_cast<std::underlying_type<OVRWindow::LOD>::type>(_LOD) - 1));
+OVRWindow::synchronizeFrameUpdate(const float dt, const ovrFrameTiming& frameTiming) {
+    // Wait for the update that was started while the previous frame was being finished.
+    // That update began its own frame of jobs, which remains valid until this frame is
+    // painted.
+    const bool isUpdated = _update.job != nullptr;
+    if (isUpdated) {
+        _jobs.wait(_update.job);
+        _update.job = nullptr;
+    } else {
+        beginJobFrame();
     }
+    _uploadService->beginFrame();
+    _occlusionCuller.beginFrame();
+    if (!isUpdated)
+        updateFrame(dt, frameTiming);
+
+    swapFrameState();
+    swapInputEvents();
 }
 
 
 void
-OVRWindow::increaseLOD() {
-    if (_LOD != OVRWindow::LOD::Highest) {
-        setLOD(static_cast<OVRWindow::LOD>(static_cast<std::underlying_type<OVRWindow::LOD>::type>(_LOD) + 1));
+OVRWindow::paintEye(const ovrEyeType eye, const ovrPosef& pose, const float dt) {
+    const auto& viewport = getOvrGlTexture(eye).OGL.Header.RenderViewport;
+    _glState.setViewport(viewport.Pos.x, viewport.Pos.y, viewport.Size.w, viewport.Size.h);
+    const auto& transforms = getRenderTransforms(eye, pose);
+    publishTransforms(eye, transforms);
+    paintGL(eye, transforms, dt);
+
+    // The application may have changed the state behind the tracker's back.
+    if (_synchronizeGLState)
+        _glState.synchronize();
+
+    // Occlusion queries are only issued for the first eye that is painted, and their
+    // results are reused for the second, so the bounds are dilated by the distance
+    // between the eyes.
+    const auto& first = _device.EyeRenderOrder[0];
+    const auto& queryEye = isEyeAlternated(first) ? _device.EyeRenderOrder[1] : first;
+    if (_occlusionCuller.isEnabled() && eye == queryEye) {
+        const Annotation annotation(isAnnotating(), _tracer, "Occlusion queries");
+        const OVRGLState::Scope scope(_glState);
+        _glState.setViewport(viewport.Pos.x, viewport.Pos.y, viewport.Size.w, viewport.Size.h);
+        const auto& left = _renderInfo[ovrEye_Left].ViewAdjust;
+        const auto& right = _renderInfo[ovrEye_Right].ViewAdjust;
+        const auto& baseline = QVector3D(left.x - right.x, left.y - right.y, left.z - right.z).length();
+        const auto& position = transforms.view.inverted().map(QVector3D());
+        _occlusionCuller.issueQueries(_glState, transforms.perspective * transforms.view, position, baseline + _nearClippingPlaneDistance);
     }
+    compositeHUD(transforms);
 }
 
 
-float
-OVRWindow::getIPD() const {
-    return ovrHmd_GetFloat(_device.Handle, OVR_KEY_IPD, OVR_DEFAULT_IPD);
+bool
+OVRWindow::isAnnotating() const {
+    return _debug.enabled && _debug.supported;
 }
 
 
 void
-OVRWindow::setIPD(const float ipd) {
-    // If the IPD is changed, then the render configuration needs to be updated.
-    _dirty.rendering = ovrHmd_SetFloat(_device.Handle, OVR_KEY_IPD, ipd);
+OVRWindow::labelObject(const GLenum identifier, const GLuint name, const char* const label) {
+    if (_debug.supported)
+        glObjectLabel(identifier, name, -1, label);
 }
 
 
 void
-OVRWindow::forceZeroIPD(const bool force) {
-    // If the IPD is changed, then the render configuration needs to be updated.
-    if (_forceZeroIPD != force) {
-        _forceZeroIPD = force;
-        _dirty.rendering = true;
+OVRWindow::beginEyePass(const ovrEyeType eye) {
+    if (isAnnotating())
+        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, EYE_PASSES[eye]);
+    _tracer.begin(EYE_PASSES[eye]);
+
+    // Time the eye on the GPU, unless its timer from a few frames ago is still pending.
+    if (_tracer.isTracing()) {
+        auto& timers = _gpuTimers;
+        if (timers.queries[0][0] == 0) {
+            glGenQueries(static_cast<GLsizei>(timers.queries.size() * ovrEye_Count), timers.queries[0].data());
+            glGenQueries(static_cast<GLsizei>(timers.timestamps.size() * ovrEye_Count), timers.timestamps[0].data());
+        }
+        const auto& slot = timers.frame % timers.queries.size();
+        if (!timers.pending[slot][eye]) {
+            glQueryCounter(timers.timestamps[slot][eye], GL_TIMESTAMP);
+            glBeginQuery(GL_TIME_ELAPSED, timers.queries[slot][eye]);
+            timers.pending[slot][eye] = true;
+            timers.active = true;
+        }
     }
-}
-
-
-float
-OVRWindow::getPixelDensity() const {
-    return _pixelDensity;
+#if defined(OVR_GL_CALL_COUNTING)
+    OVRGLFunctions::resetCallCounts();
+#endif
 }
 
 
 void
-OVRWindow::setPixelDensity(const float density) {
-    // When the pixel density is changed, the render target needs to be resized.
-    if (_pixelDensity != density) {
-        _pixelDensity = density <= 0.0f ? 0.5f : density;
-        _dirty.renderTarget = true;
+OVRWindow::endEyePass(const ovrEyeType eye) {
+#if defined(OVR_GL_CALL_COUNTING)
+    _debug.callCounts[eye] = OVRGLFunctions::getCallCounts();
+#endif
+    if (_gpuTimers.active) {
+        glEndQuery(GL_TIME_ELAPSED);
+        _gpuTimers.active = false;
     }
+    _tracer.end(EYE_PASSES[eye]);
+    if (isAnnotating())
+        glPopDebugGroup();
 }
 
 
-float
-OVRWindow::getNearClippingDistance() const {
-    return _nearClippingPlaneDistance;
+void
+OVRWindow::collectGPUTimers() {
+    auto& timers = _gpuTimers;
+    if (timers.queries[0][0] == 0)
+        return;
+
+    // The GPU's timestamps are converted to the trace's clock with the offset between the
+    // two clocks, which is measured (without waiting for the GPU) once a result is available.
+    double offset = 0.0;
+    bool calibrated = false;
+
+    // Only the timers whose results are available are collected so the CPU never waits.
+    // The timestamp query was issued before the timer query, so it is available as well.
+    for (std::size_t slot = 0; slot < timers.queries.size(); ++slot) {
+        for (unsigned int eye = 0; eye < ovrEye_Count; ++eye) {
+            if (!timers.pending[slot][eye])
+                continue;
+
+            const auto& query = timers.queries[slot][eye];
+            GLint available = GL_FALSE;
+            glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                if (!calibrated) {
+                    GLint64 now = 0;
+                    glGetInteger64v(GL_TIMESTAMP, &now);
+                    offset = OVRTracer::getTime() - 1e-9 * now;
+                    calibrated = true;
+                }
+                GLuint64 elapsed = 0;
+                GLuint64 start = 0;
+                glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+                glGetQueryObjectui64v(timers.timestamps[slot][eye], GL_QUERY_RESULT, &start);
+                _tracer.complete(EYE_GPU_PASSES[eye], 1e-9 * start + offset, 1e-9 * elapsed, GPU_TRACE_THREAD);
+                timers.pending[slot][eye] = false;
+            }
+        }
+    }
+    ++timers.frame;
 }
 
 
 void
-OVRWindow::setNearClippingDistance(const float near) {
-    if (_nearClippingPlaneDistance != near) {
-        _nearClippingPlaneDistance = near;
-        for (auto& dirty : _dirty.projections) {
-            dirty = true;
+OVRWindow::measureLatency(const ovrFrameTiming& frameTiming) {
+    if (!isFeatureEnabled(OVRWindow::Feature::LatencyTesting))
+        return;
+
+    float latency = -1.0f;
+    if (_latency.simulated) {
+        if (frameTiming.ThisFrameSeconds - _latency.simulationTime >= 1.0) {
+            _latency.simulationTime = frameTiming.ThisFrameSeconds;
+            latency = static_cast<float>(frameTiming.ScanoutMidpointSeconds - _latency.sampleTime);
         }
+    } else {
+        // A result is only returned once, after the test that produced it is complete.
+        const char* const result = ovrHmd_GetLatencyTestResult(_device.Handle);
+        if (result != nullptr)
+            latency = parseLatencyTestResult(result);
     }
+    if (latency < 0.0f)
+        return;
+
+    // Replace the oldest measurement, then update the statistics.
+    auto& measurements = _latency.measurements;
+    if (measurements.size() < LATENCY_MEASUREMENT_COUNT)
+        measurements.append(latency);
+    else
+        measurements[_latency.next] = latency;
+    _latency.next = (_latency.next + 1) % LATENCY_MEASUREMENT_COUNT;
+
+    auto& statistics = _latency.statistics;
+    statistics.minimum = *std::min_element(measurements.begin(), measurements.end());
+    statistics.maximum = *std::max_element(measurements.begin(), measurements.end());
+    statistics.mean = std::accumulate(measurements.begin(), measurements.end(), 0.0f) / measurements.size();
+    statistics.last = latency;
+    statistics.count = static_cast<unsigned int>(measurements.size());
+
+    _tracer.counter("Latency (ms)", 1000.0 * latency);
+    emit latencyMeasured(latency);
 }
 
 
-float
-OVRWindow::getFarClippingDistance() const {
-    return _farClippingPlaneDistance;
+void
+OVRWindow::swapInputEvents() {
+    std::lock_guard<std::mutex> lock(_inputLatency.mutex);
+    _inputLatency.consumed.clear();
+    _inputLatency.consumed.swap(_inputLatency.tagged);
 }
 
 
 void
-OVRWindow::setFarClippingDistance(const float far) {
-    if (_farClippingPlaneDistance != far) {
-        _farClippingPlaneDistance = far;
-        for (auto& dirty : _dirty.projections) {
-            dirty = true;
-        }
+OVRWindow::measureInputLatency(const double scanoutTime) {
+    auto& histogram = _inputLatency.histogram;
+    for (const auto& time : _inputLatency.consumed) {
+        const auto& latency = static_cast<float>(std::max(scanoutTime - time, 0.0));
+        const auto& bin = std::min(static_cast<int>(latency / histogram.binWidth), histogram.bins.size() - 1);
+        ++histogram.bins[bin];
+
+        histogram.minimum = histogram.count > 0 ? std::min(histogram.minimum, latency) : latency;
+        histogram.maximum = histogram.count > 0 ? std::max(histogram.maximum, latency) : latency;
+        ++histogram.count;
+        _inputLatency.sum += latency;
+        histogram.mean = static_cast<float>(_inputLatency.sum / histogram.count);
+
+        _tracer.counter("Input latency (ms)", 1000.0 * latency);
     }
+    _inputLatency.consumed.clear();
 }
 
 
-bool
-OVRWindow::isMultisamplingEnabled() const {
-    return getOvrGlConfig().OGL.Header.Multisample == 1;
+void
+OVRWindow::initializeContext() {
+    _gl.setFormat(requestedFormat());
+    const auto result = _gl.create();
+    assert(result);
+    makeCurrent();
+    assert(hasValidGL());
+    initializeOpenGLFunctions();
+    const auto& format = _gl.format();
+    _debug.supported = 10 * format.majorVersion() + format.minorVersion() >= 43 || _gl.hasExtension("GL_KHR_debug");
+    _uploadService.reset(new OVRUploadService(_gl));
+    initializeGL();
+    _glState.synchronize();
 }
 
 
 void
-OVRWindow::enableMultisampling(const bool enable) {
-    auto& multisample = getOvrGlConfig().OGL.Header.Multisample;
-    if (static_cast<bool>(multisample) != enable) {
-        multisample = enable ? 1 : 0;
-        _dirty.rendering = true;
+OVRWindow::sanitizeHUD(const double time) {
+    if (!_HUD.enabled)
+        return;
+
+    const auto& interval = _HUD.refreshInterval;
+    if (interval > 0.0f && time - _HUD.refreshTime >= interval)
+        _HUD.dirty = true;
+
+    if (_HUD.dirty) {
+        const Annotation annotation(isAnnotating(), _tracer, "sanitizeHUD");
+        const OVRGLState::Scope scope(_glState);
+        const auto& resolution = _HUD.resolution;
+
+        // Initialize the shader program and the vertex buffer used to composite the HUD.
+        if (!_HUD.program) {
+            static const char* const VERTEX_SHADER =
+                "#version 120\n"
+                "attribute vec2 position;\n"
+                "attribute vec2 texcoord;\n"
+                "uniform mat4 ortho;\n"
+                "varying vec2 uv;\n"
+                "void main() {\n"
+                "    uv = texcoord;\n"
+                "    gl_Position = ortho * vec4(position, 0.0, 1.0);\n"
+                "}\n";
+            static const char* const FRAGMENT_SHADER =
+                "#version 120\n"
+                "uniform sampler2D hud;\n"
+                "varying vec2 uv;\n"
+                "void main() {\n"
+                "    gl_FragColor = texture2D(hud, uv);\n"
+                "}\n";
+            _HUD.program.reset(new QOpenGLShaderProgram);
+            auto& program = *_HUD.program;
+            program.addShaderFromSourceCode(QOpenGLShader::Vertex, VERTEX_SHADER);
+            program.addShaderFromSourceCode(QOpenGLShader::Fragment, FRAGMENT_SHADER);
+            program.bindAttributeLocation("position", 0);
+            program.bindAttributeLocation("texcoord", 1);
+            const auto result = program.link();
+            assert(result);
+
+            glGenBuffers(1, &_HUD.vbo);
+            assert(_HUD.vbo != 0);
+        }
+
+        // Resize the texture and the quad it is mapped onto. The quad is centered in the
+        // eye's view and its vertices are expressed in pixels, where the Y axis points
+        // downwards, as expected by the orthographic projection.
+        if (!_HUD.framebuffer || _HUD.framebuffer->size() != resolution) {
+            _HUD.framebuffer.reset(new QOpenGLFramebufferObject(resolution, QOpenGLFramebufferObject::CombinedDepthStencil));
+            assert(_HUD.framebuffer->isValid());
+            labelObject(GL_FRAMEBUFFER, _HUD.framebuffer->handle(), "OVRWindow HUD");
+            labelObject(GL_TEXTURE, _HUD.framebuffer->texture(), "OVRWindow HUD");
+
+            const auto& w = 0.5f * resolution.width();
+            const auto& h = 0.5f * resolution.height();
+            const GLfloat vertices[] = {
+                -w, -h, 0.0f, 1.0f,
+                 w, -h, 1.0f, 1.0f,
+                -w,  h, 0.0f, 0.0f,
+                 w,  h, 1.0f, 0.0f,
+            };
+            _glState.bindBuffer(GL_ARRAY_BUFFER, _HUD.vbo);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+            labelObject(GL_BUFFER, _HUD.vbo, "OVRWindow HUD quad");
+        }
+
+        // Redraw the HUD. Note that QPainter produces premultiplied alpha.
+        _HUD.framebuffer->bind();
+        {
+            QOpenGLPaintDevice device(resolution);
+            QPainter painter(&device);
+            painter.setCompositionMode(QPainter::CompositionMode_Source);
+            painter.fillRect(QRect(QPoint(0, 0), resolution), Qt::transparent);
+            painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+            paintHUD(painter, resolution);
+        }
+        _HUD.framebuffer->release();
+
+        // QPainter resets much of the state to its default values when it is done
+        // painting, without going through the tracker, so the state is read back and the
+        // state that differs from the scope's is set again when the scope is left.
+        _glState.synchronize();
+
+        // The HUD is composited into the eye buffers, which therefore need to be repainted.
+        _idle.valid = false;
+
+        // Mark the HUD as sanitized.
+        _HUD.refreshTime = time;
+        _HUD.dirty = false;
     }
 }
 
 
 void
-OVRWindow::toggleMultisampling() {
-    auto& multisample = getOvrGlConfig().OGL.Header.Multisample;
-    multisample = !multisample;
-    _dirty.rendering = true;
+OVRWindow::compositeHUD(const OVRWindow::RenderTransforms& transforms) {
+    if (!_HUD.enabled || !_HUD.framebuffer)
+        return;
+
+    const OVRGLState::Scope scope(_glState);
+    _glState.setCapability(GL_DEPTH_TEST, false);
+    _glState.setCapability(GL_CULL_FACE, false);
+    _glState.setCapability(GL_SCISSOR_TEST, false);
+    _glState.setCapability(GL_STENCIL_TEST, false);
+    _glState.setCapability(GL_BLEND, true);
+    _glState.setBlendFunction(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    _glState.bindTexture(_HUD.framebuffer->texture());
+
+    auto& program = *_HUD.program;
+    _glState.useProgram(program.programId());
+    program.setUniformValue("ortho", transforms.ortho);
+    program.setUniformValue("hud", 0);
+
+    bindVertexArray();
+    _glState.bindBuffer(GL_ARRAY_BUFFER, _HUD.vbo);
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), nullptr);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), reinterpret_cast<const GLvoid*>(2 * sizeof(GLfloat)));
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glDisableVertexAttribArray(0);
+    glDisableVertexAttribArray(1);
 }
 
 
 void
-OVRWindow::updateGL() {
-    if (isExposed() && hasValidGL()) {
-        makeCurrent();
-        paintGL();
-        doneCurrent();
-        requestUpdateGL();
+OVRWindow::bindVertexArray() {
+    if (_vertexArray == 0) {
+        glGenVertexArrays(1, &_vertexArray);
+        assert(_vertexArray != 0);
+        _glState.bindVertexArray(_vertexArray);
+        labelObject(GL_VERTEX_ARRAY, _vertexArray, "OVRWindow vertex array");
     }
+    _glState.bindVertexArray(_vertexArray);
+}
+
+
+bool
+OVRWindow::isReprojectionRequired(const ovrEyeType eye, const double deadline) const {
+    return
+        _reprojection.enabled &&
+        _reprojection.valid &&
+        !_reprojection.reprojected[eye] &&
+        ovr_GetTimeInSeconds() + _reprojection.paintDuration[eye] > deadline;
+}
+
+
+bool
+OVRWindow::isEyeAlternated(const ovrEyeType eye) const {
+    return _alternateEye.enabled && _reprojection.valid && eye != _alternateEye.eye;
+}
+
+
+bool
+OVRWindow::isRenderTargetHistoryRequired() const {
+    return _reprojection.enabled || _alternateEye.enabled;
 }
 
 
 void
-OVRWindow::requestUpdateGL()
-{
-    if (!_pendingUpdateRequest) {
-        _pendingUpdateRequest = true;
-        QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateRequest));
+OVRWindow::reprojectEye(const ovrEyeType eye, const ovrPosef& pose) {
+    const OVRGLState::Scope scope(_glState);
+
+    // Initialize the shader program and the vertex buffer used to reproject an eye. A
+    // quad covering the eye's viewport is drawn and each fragment's position is mapped
+    // to the previous frame's clip space with the reprojection matrix.
+    if (!_reprojection.program) {
+        static const char* const VERTEX_SHADER =
+            "#version 120\n"
+            "attribute vec2 position;\n"
+            "uniform mat4 reprojection;\n"
+            "varying vec4 previous;\n"
+            "void main() {\n"
+            "    previous = reprojection * vec4(position, 0.0, 1.0);\n"
+            "    gl_Position = vec4(position, 0.0, 1.0);\n"
+            "}\n";
+        static const char* const FRAGMENT_SHADER =
+            "#version 120\n"
+            "uniform sampler2D history;\n"
+            "uniform vec4 viewport;\n"
+            "varying vec4 previous;\n"
+            "void main() {\n"
+            "    vec2 uv = 0.5 * previous.xy / previous.w + 0.5;\n"
+            "    if (previous.w <= 0.0 || any(lessThan(uv, vec2(0.0))) || any(greaterThan(uv, vec2(1.0))))\n"
+            "        gl_FragColor = vec4(0.0, 0.0, 0.0, 1.0);\n"
+            "    else\n"
+            "        gl_FragColor = texture2D(history, viewport.xy + uv * viewport.zw);\n"
+            "}\n";
+        _reprojection.program.reset(new QOpenGLShaderProgram);
+        auto& program = *_reprojection.program;
+        program.addShaderFromSourceCode(QOpenGLShader::Vertex, VERTEX_SHADER);
+        program.addShaderFromSourceCode(QOpenGLShader::Fragment, FRAGMENT_SHADER);
+        program.bindAttributeLocation("position", 0);
+        const auto result = program.link();
+        assert(result);
+
+        const GLfloat vertices[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+        glGenBuffers(1, &_reprojection.vbo);
+        assert(_reprojection.vbo != 0);
+        _glState.bindBuffer(GL_ARRAY_BUFFER, _reprojection.vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        labelObject(GL_BUFFER, _reprojection.vbo, "OVRWindow reprojection quad");
     }
+
+    // Only the head's orientation is taken into account: a direction in the current eye's
+    // view space is rotated into world space, then into the previous eye's view space.
+    const auto& perspective = getRenderTransforms(eye, pose).perspective;
+    const auto& reprojection = (
+        perspective *
+        getViewRotation(_reprojection.poses[eye]) *
+        getViewRotation(pose).transposed() *
+        perspective.inverted()
+    );
+
+    // The eye's viewport in the render target, in texture coordinates.
+    const auto& header = getOvrGlTexture(eye).OGL.Header;
+    const auto& viewport = header.RenderViewport;
+    const auto& w = static_cast<GLfloat>(header.TextureSize.w);
+    const auto& h = static_cast<GLfloat>(header.TextureSize.h);
+
+    _glState.setViewport(viewport.Pos.x, viewport.Pos.y, viewport.Size.w, viewport.Size.h);
+    _glState.setCapability(GL_DEPTH_TEST, false);
+    _glState.setCapability(GL_CULL_FACE, false);
+    _glState.setCapability(GL_SCISSOR_TEST, false);
+    _glState.setCapability(GL_STENCIL_TEST, false);
+    _glState.setCapability(GL_BLEND, false);
+    _glState.bindTexture(_renderTarget.history);
+
+    auto& program = *_reprojection.program;
+    _glState.useProgram(program.programId());
+    program.setUniformValue("reprojection", reprojection);
+    program.setUniformValue("viewport", viewport.Pos.x / w, viewport.Pos.y / h, viewport.Size.w / w, viewport.Size.h / h);
+    program.setUniformValue("history", 0);
+
+    bindVertexArray();
+    _glState.bindBuffer(GL_ARRAY_BUFFER, _reprojection.vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glDisableVertexAttribArray(0);
+
+    _reprojection.reprojected[eye] = true;
 }
 
 
 void
-OVRWindow::configureGL() {
-    auto& OGL = getOvrGlConfig().OGL;
+OVRWindow::swapRenderTargetHistory() {
+    std::swap(_renderTarget.pixel, _renderTarget.history);
 
-    OGL.Header.API = ovrRenderAPI_OpenGL;
-    OGL.Header.RTSize.w = _device.Resolution.w;
-    OGL.Header.RTSize.h = _device.Resolution.h;
-    OGL.Header.Multisample = 0;
-#if defined(Q_OS_LINUX)
-    OGL.Disp = getXDisplay(this);
-    OGL.Win = static_cast<::Window>(winId());
-    assert(OGL.Disp != nullptr);
-#elif defined(Q_OS_WIN32)
-    __OVR_GL_CONFIG.Window = static_cast<::HWND>(winId());
-#endif
-    _dirty.rendering = true;
+    _glState.bindFramebuffer(_renderTarget.fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _renderTarget.pixel, 0);
+    _glState.bindFramebuffer(0);
+    for (const auto& eye : _device.EyeRenderOrder) {
+        getOvrGlTexture(eye).OGL.TexId = _renderTarget.pixel;
+    }
 }
 
 
 void
-OVRWindow::paintGL() {
-    // Update all configurations before drawing the frame.
-    sanitizeRenderTargetConfiguration();
-    sanitizeDeviceConfiguration();
-    sanitizeRenderingConfiguration();
+OVRWindow::sanitizeUpsampling() {
+    // The output buffers are not updated while upsampling is inactive, so they are stale
+    // once it becomes active again.
+    _upsampling.active = _upsampling.enabled && _pixelDensity < 1.0f;
+    if (!_upsampling.active) {
+        _upsampling.valid = false;
+        return;
+    }
+
+    if (_upsampling.textures[0] == 0) {
+        glGenTextures(2, _upsampling.textures);
+        glGenFramebuffers(2, _upsampling.fbos);
+        assert(_upsampling.textures[0] != 0 && _upsampling.textures[1] != 0);
+        assert(_upsampling.fbos[0] != 0 && _upsampling.fbos[1] != 0);
+        for (unsigned int i = 0; i < ovrEye_Count; ++i) {
+            getSubmittedOvrGlTexture(static_cast<ovrEyeType>(i)).OGL.Header.API = ovrRenderAPI_OpenGL;
+        }
+    }
 
+    // The output buffers have the render target's layout at a pixel density of 1.
     const auto& hmd = _device.Handle;
-    const auto& frameTiming = ovrHmd_BeginFrame(hmd, 0);
-    const auto& dt = frameTiming.DeltaSeconds;
+    const auto& sizeL = ovrHmd_GetFovTextureSize(hmd, ovrEye_Left,  _FOV[ovrEye_Left],  1.0f);
+    const auto& sizeR = ovrHmd_GetFovTextureSize(hmd, ovrEye_Right, _FOV[ovrEye_Right], 1.0f);
+    const auto& newSize = QSize(sizeL.w + sizeR.w, std::max(sizeL.h, sizeR.h));
+    if (_upsampling.resolution != newSize) {
+        const Annotation annotation(isAnnotating(), _tracer, "sanitizeUpsampling");
+        _upsampling.resolution = newSize;
+        _glState.setActiveTexture(GL_TEXTURE0);
+        for (unsigned int i = 0; i < 2; ++i) {
+            _glState.bindTexture(_upsampling.textures[i]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, newSize.width(), newSize.height(), 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+            _glState.bindFramebuffer(_upsampling.fbos[i]);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _upsampling.textures[i], 0);
+            assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+            labelObject(GL_FRAMEBUFFER, _upsampling.fbos[i], "OVRWindow upsampling target");
+            labelObject(GL_TEXTURE, _upsampling.textures[i], "OVRWindow upsampling buffer");
+        }
+        _glState.bindFramebuffer(0);
+        _glState.bindTexture(0);
+        _upsampling.valid = false;
+    }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, _renderTarget.fbo);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // A new projection invalidates the previous output.
+    if (_dirty.projections[ovrEye_Left] || _dirty.projections[ovrEye_Right])
+        _upsampling.valid = false;
+
+    for (unsigned int i = 0; i < ovrEye_Count; ++i) {
+        auto& ogl = getSubmittedOvrGlTexture(static_cast<ovrEyeType>(i)).OGL;
+        auto& header = ogl.Header;
+        ogl.TexId = _upsampling.textures[_upsampling.current];
+        header.TextureSize.w = newSize.width();
+        header.TextureSize.h = newSize.height();
+        header.RenderViewport.Pos.x = i == ovrEye_Left ? 0 : sizeL.w;
+        header.RenderViewport.Pos.y = 0;
+        header.RenderViewport.Size = i == ovrEye_Left ? sizeL : sizeR;
+    }
 
-    for (const auto& eye : _device.EyeRenderOrder) {
-        auto& texConfig = getOvrGlTexture(eye);
-        const auto& viewport = texConfig.OGL.Header.RenderViewport;
-        const auto& pose = ovrHmd_BeginEyeRender(hmd, eye);
-        const auto& renderTransforms = getRenderTransforms(eye, pose);
+    // Advance the jitter, which is relative to the center of a pixel.
+    const auto& index = _upsampling.frame++ % UPSAMPLING_JITTER_COUNT + 1;
+    _upsampling.jitter[0] = getHaltonNumber(index, 2) - 0.5f;
+    _upsampling.jitter[1] = getHaltonNumber(index, 3) - 0.5f;
+}
 
-        glViewport(viewport.Pos.x, viewport.Pos.y, viewport.Size.w, viewport.Size.h);
-        paintGL(eye, renderTransforms, dt);
-        ovrHmd_EndEyeRender(hmd, eye, pose, &texConfig.Texture);
-    }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    ovrHmd_EndFrame(hmd);
 
-    // TODO Remove this block when ovrHmd_EndFrame cleans up after itself correctly.
-    {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glUseProgram(0);
+void
+OVRWindow::upsampleEye(const ovrEyeType eye, const ovrPosef& pose) {
+    const Annotation annotation(isAnnotating(), _tracer, "Temporal upsampling");
+    const OVRGLState::Scope scope(_glState);
+
+    // Initialize the shader program, the vertex buffer and the sampler used to upsample
+    // an eye. A quad covering the eye's viewport in the output buffer is drawn. Each
+    // fragment samples the current image where the jitter moved it, then blends it with
+    // the previous output, reprojected like in reprojectEye and clamped to the range of
+    // the current image's neighborhood.
+    if (!_upsampling.program) {
+        static const char* const VERTEX_SHADER =
+            "#version 120\n"
+            "attribute vec2 position;\n"
+            "uniform mat4 reprojection;\n"
+            "varying vec2 ndc;\n"
+            "varying vec4 previous;\n"
+            "void main() {\n"
+            "    ndc = position;\n"
+            "    previous = reprojection * vec4(position, 0.0, 1.0);\n"
+            "    gl_Position = vec4(position, 0.0, 1.0);\n"
+            "}\n";
+        static const char* const FRAGMENT_SHADER =
+            "#version 120\n"
+            "uniform sampler2D current;\n"
+            "uniform sampler2D history;\n"
+            "uniform vec4 currentViewport;\n"
+            "uniform vec4 historyViewport;\n"
+            "uniform vec2 jitter;\n"
+            "uniform vec2 texel;\n"
+            "uniform float blend;\n"
+            "varying vec2 ndc;\n"
+            "varying vec4 previous;\n"
+            "void main() {\n"
+            "    vec2 uv = currentViewport.xy + (0.5 * (ndc + jitter) + 0.5) * currentViewport.zw;\n"
+            "    vec3 color = texture2D(current, uv).rgb;\n"
+            "    vec3 a = texture2D(current, uv + vec2(texel.x, 0.0)).rgb;\n"
+            "    vec3 b = texture2D(current, uv - vec2(texel.x, 0.0)).rgb;\n"
+            "    vec3 c = texture2D(current, uv + vec2(0.0, texel.y)).rgb;\n"
+            "    vec3 d = texture2D(current, uv - vec2(0.0, texel.y)).rgb;\n"
+            "    vec3 minimum = min(color, min(min(a, b), min(c, d)));\n"
+            "    vec3 maximum = max(color, max(max(a, b), max(c, d)));\n"
+            "    vec2 past = 0.5 * previous.xy / previous.w + 0.5;\n"
+            "    if (blend < 1.0 && previous.w > 0.0 && all(greaterThanEqual(past, vec2(0.0))) && all(lessThanEqual(past, vec2(1.0)))) {\n"
+            "        vec3 history = texture2D(history, historyViewport.xy + past * historyViewport.zw).rgb;\n"
+            "        color = mix(clamp(history, minimum, maximum), color, blend);\n"
+            "    }\n"
+            "    gl_FragColor = vec4(color, 1.0);\n"
+            "}\n";
+        _upsampling.program.reset(new QOpenGLShaderProgram);
+        auto& program = *_upsampling.program;
+        program.addShaderFromSourceCode(QOpenGLShader::Vertex, VERTEX_SHADER);
+        program.addShaderFromSourceCode(QOpenGLShader::Fragment, FRAGMENT_SHADER);
+        program.bindAttributeLocation("position", 0);
+        const auto result = program.link();
+        assert(result);
+
+        const GLfloat vertices[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+        glGenBuffers(1, &_upsampling.vbo);
+        assert(_upsampling.vbo != 0);
+        _glState.bindBuffer(GL_ARRAY_BUFFER, _upsampling.vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        labelObject(GL_BUFFER, _upsampling.vbo, "OVRWindow upsampling quad");
+
+        // The render target's pixel buffer is sampled with nearest filtering elsewhere,
+        // but upsampling requires bilinear filtering.
+        glGenSamplers(1, &_upsampling.sampler);
+        assert(_upsampling.sampler != 0);
+        glSamplerParameteri(_upsampling.sampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glSamplerParameteri(_upsampling.sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glSamplerParameteri(_upsampling.sampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glSamplerParameteri(_upsampling.sampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     }
+
+    // The previous output was rendered without jitter, so the reprojection uses the
+    // projection without it.
+    const auto& perspective = _renderTransforms[eye].perspective;
+    const auto& reprojection = (
+        perspective *
+        getViewRotation(_upsampling.poses[eye]) *
+        getViewRotation(pose).transposed() *
+        perspective.inverted()
+    );
+
+    // The eye's viewports in the render target and the output buffer, in texture coordinates.
+    const auto& input = getOvrGlTexture(eye).OGL.Header;
+    const auto& output = getSubmittedOvrGlTexture(eye).OGL;
+    const auto& target = 1 - _upsampling.current;
+    const auto& iw = static_cast<GLfloat>(input.TextureSize.w);
+    const auto& ih = static_cast<GLfloat>(input.TextureSize.h);
+    const auto& ow = static_cast<GLfloat>(output.Header.TextureSize.w);
+    const auto& oh = static_cast<GLfloat>(output.Header.TextureSize.h);
+    const auto& iv = input.RenderViewport;
+    const auto& ov = output.Header.RenderViewport;
+
+    _glState.bindFramebuffer(_upsampling.fbos[target]);
+    _glState.setViewport(ov.Pos.x, ov.Pos.y, ov.Size.w, ov.Size.h);
+    _glState.setCapability(GL_DEPTH_TEST, false);
+    _glState.setCapability(GL_CULL_FACE, false);
+    _glState.setCapability(GL_SCISSOR_TEST, false);
+    _glState.setCapability(GL_STENCIL_TEST, false);
+    _glState.setCapability(GL_BLEND, false);
+
+    // Only the first texture unit is tracked, so the second is bound directly.
+    _glState.setActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, _upsampling.textures[_upsampling.current]);
+    _glState.setActiveTexture(GL_TEXTURE0);
+    _glState.bindTexture(_renderTarget.pixel);
+    glBindSampler(0, _upsampling.sampler);
+    glBindSampler(1, _upsampling.sampler);
+
+    auto& program = *_upsampling.program;
+    _glState.useProgram(program.programId());
+    program.setUniformValue("reprojection", reprojection);
+    program.setUniformValue("current", 0);
+    program.setUniformValue("history", 1);
+    program.setUniformValue("currentViewport", iv.Pos.x / iw, iv.Pos.y / ih, iv.Size.w / iw, iv.Size.h / ih);
+    program.setUniformValue("historyViewport", ov.Pos.x / ow, ov.Pos.y / oh, ov.Size.w / ow, ov.Size.h / oh);
+    program.setUniformValue("jitter", 2.0f * _upsampling.jitter[0] / iv.Size.w, 2.0f * _upsampling.jitter[1] / iv.Size.h);
+    program.setUniformValue("texel", 1.0f / iw, 1.0f / ih);
+    program.setUniformValue("blend", _upsampling.valid ? UPSAMPLING_BLEND : 1.0f);
+
+    bindVertexArray();
+    _glState.bindBuffer(GL_ARRAY_BUFFER, _upsampling.vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glDisableVertexAttribArray(0);
+
+    glBindSampler(0, 0);
+    glBindSampler(1, 0);
+    _glState.setActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    _glState.setActiveTexture(GL_TEXTURE0);
+
+    getSubmittedOvrGlTexture(eye).OGL.TexId = _upsampling.textures[target];
+    _upsampling.poses[eye] = pose;
 }
 
 
@@ -530,10 +2768,18 @@ OVRWindow::getOvrGlTexture(const ovrEyeType eye) const {
 }
 
 
+ovrGLTexture&
+OVRWindow::getSubmittedOvrGlTexture(const ovrEyeType eye) const {
+    static std::array<ovrGLTexture, ovrEye_Count> UPSAMPLED_INSTANCES;
+    return _upsampling.active ? UPSAMPLED_INSTANCES[eye] : getOvrGlTexture(eye);
+}
+
+
 void
 OVRWindow::sanitizeRenderTargetConfiguration() {
     // Reconfigure the render target.
     if (_dirty.renderTarget) {
+        const Annotation annotation(isAnnotating(), _tracer, "sanitizeRenderTargetConfiguration");
         bool isInitialized = _renderTarget.fbo;
         if (!isInitialized) {
             // Initialize the frame buffer object and its textures.
@@ -552,23 +2798,45 @@ OVRWindow::sanitizeRenderTargetConfiguration() {
             for (const auto& eye : _device.EyeRenderOrder)
                 getOvrGlTexture(eye).OGL.Header.API = ovrRenderAPI_OpenGL;
         }
-        glBindFramebuffer(GL_FRAMEBUFFER, _renderTarget.fbo);
+        _glState.bindFramebuffer(_renderTarget.fbo);
 
         const auto& hmd = _device.Handle;
         const auto& sizeL = ovrHmd_GetFovTextureSize(hmd, ovrEye_Left,  _FOV[ovrEye_Left],  _pixelDensity);
         const auto& sizeR = ovrHmd_GetFovTextureSize(hmd, ovrEye_Right, _FOV[ovrEye_Right], _pixelDensity);
         const auto& newSize = QSize(sizeL.w + sizeR.w, std::max(sizeL.h, sizeR.h));
-        if (_renderTarget.resolution != newSize) {
+
+        // Reprojection and alternate-eye rendering require a history buffer that holds
+        // the previous frame.
+        const bool allocateHistory = isRenderTargetHistoryRequired() && _renderTarget.history == 0;
+        if (allocateHistory) {
+            glGenTextures(1, &_renderTarget.history);
+            assert(_renderTarget.history != 0);
+        }
+        if (_renderTarget.resolution != newSize || allocateHistory) {
             _renderTarget.resolution = newSize;
+            ++_reconfigurations.renderTarget;
             const auto& w = newSize.width();
             const auto& h = newSize.height();
 
             // Bind and resize the buffers.
-            glBindTexture(GL_TEXTURE_2D, _renderTarget.pixel);
+            _glState.setActiveTexture(GL_TEXTURE0);
+            _glState.bindTexture(_renderTarget.pixel);
             glBindRenderbuffer(GL_RENDERBUFFER, _renderTarget.depth);
             glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
             glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, w, h);
 
+            // The history buffer is configured like the pixel buffer since they are swapped.
+            if (_renderTarget.history != 0) {
+                _glState.bindTexture(_renderTarget.history);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+                labelObject(GL_TEXTURE, _renderTarget.history, "OVRWindow history buffer");
+                _glState.bindTexture(_renderTarget.pixel);
+            }
+            _reprojection.valid = false;
+            _idle.valid = false;
+
             // If the framebuffer object was just initialized, configure each buffer appropriately.
             if (!isInitialized) {
                 // Configure the pixel buffer.
@@ -583,27 +2851,32 @@ OVRWindow::sanitizeRenderTargetConfiguration() {
 
                 // Make sure the framebuffer object is valid.
                 assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+                labelObject(GL_FRAMEBUFFER, _renderTarget.fbo, "OVRWindow render target");
+                labelObject(GL_TEXTURE, _renderTarget.pixel, "OVRWindow pixel buffer");
+                labelObject(GL_RENDERBUFFER, _renderTarget.depth, "OVRWindow depth buffer");
             }
-            glBindTexture(GL_TEXTURE_2D, 0);
+            _glState.bindTexture(0);
             glBindRenderbuffer(GL_RENDERBUFFER, 0);
 
-            // Configure SDK distortion correction parameters.
-            for (unsigned int i = 0; i < ovrEye_Count; ++i) {
-                auto& ogl = getOvrGlTexture(static_cast<ovrEyeType>(i)).OGL;
-                auto& header = ogl.Header;
-
-                ogl.TexId = _renderTarget.pixel;
-                header.TextureSize.w = w;
-                header.TextureSize.h = h;
-                header.RenderViewport.Pos.x = i * ((w + 1) * 0.5);
-                header.RenderViewport.Pos.y = 0;
-                header.RenderViewport.Size.w = w * 0.5f;
-                header.RenderViewport.Size.h = h;
-            }
             // Mark the rendering configuration as dirty since the render target has been resized.
             _dirty.rendering = true;
         }
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        _glState.bindFramebuffer(0);
+
+        // Configure SDK distortion correction parameters. Each eye's viewport is sized after
+        // its own FOV, which may differ from the other eye's.
+        for (unsigned int i = 0; i < ovrEye_Count; ++i) {
+            auto& ogl = getOvrGlTexture(static_cast<ovrEyeType>(i)).OGL;
+            auto& header = ogl.Header;
+            const auto& size = i == ovrEye_Left ? sizeL : sizeR;
+
+            ogl.TexId = _renderTarget.pixel;
+            header.TextureSize.w = newSize.width();
+            header.TextureSize.h = newSize.height();
+            header.RenderViewport.Pos.x = i == ovrEye_Left ? 0 : sizeL.w;
+            header.RenderViewport.Pos.y = 0;
+            header.RenderViewport.Size = size;
+        }
 
         // Mark the render target as sanitized.
         _dirty.renderTarget = false;
@@ -629,9 +2902,9 @@ OVRWindow::sanitizeDeviceConfiguration() {
     };
     static const auto& getSensorCaps = [this]() {
         const auto& features = {
-            OVRWindow::Feature::LowPersistence,
-            OVRWindow::Feature::LatencyTesting,
-            OVRWindow::Feature::DynamicPrediction
+            OVRWindow::Feature::OrientationTracking,
+            OVRWindow::Feature::YawCorrection,
+            OVRWindow::Feature::PositionalTracking
         };
         unsigned int caps = 0;
         for (const auto& feature : features) {
@@ -643,6 +2916,7 @@ OVRWindow::sanitizeDeviceConfiguration() {
     };
     const auto& hmd = _device.Handle;
     if (_dirty.device.hmd) {
+        const Annotation annotation(isAnnotating(), _tracer, "sanitizeDeviceConfiguration (HMD)");
         ovrHmd_SetEnabledCaps(hmd, getHmdCaps());
 
         // Mark the HMD's configuration as sanitized. Note that a change to some of the
@@ -651,6 +2925,7 @@ OVRWindow::sanitizeDeviceConfiguration() {
         _dirty.rendering = true;
     }
     if (_dirty.device.sensor) {
+        const Annotation annotation(isAnnotating(), _tracer, "sanitizeDeviceConfiguration (sensor)");
         // If no sensor capability is activated, stop the sensor.
         const auto& sensorCaps = getSensorCaps();
         if (sensorCaps) {
@@ -683,16 +2958,60 @@ OVRWindow::sanitizeRenderingConfiguration() {
         return caps;
     };
     const auto& hmd = _device.Handle;
+    const auto& configureRendering = [this, &hmd](const ovrRenderAPIConfig* const config, const unsigned int caps) {
+        ++_reconfigurations.configureRendering;
+        return ovrHmd_ConfigureRendering(hmd, config, caps, _FOV, _renderInfo);
+    };
+    const bool reconfigure = _dirty.rendering || _dirty.viewAdjust;
     if (_dirty.rendering) {
-        const auto result = ovrHmd_ConfigureRendering(hmd, &getOvrGlConfig().Config, getDistortionCaps(), _FOV, _renderInfo);
-        assert(result);
+        const Annotation annotation(isAnnotating(), _tracer, "sanitizeRenderingConfiguration");
+        if (isOffscreen() || _distortion.enabled) {
+            // Either there is no window to perform distortion correction on, or the
+            // correction is performed by the OVRWindow, so only the eye render information
+            // is required. The SDK's distortion renderer is shut down if need be.
+            if (_distortion.configured) {
+                configureRendering(nullptr, 0);
+                _distortion.configured = false;
+            }
+            for (unsigned int i = 0; i < ovrEye_Count; ++i) {
+                const auto& eye = static_cast<ovrEyeType>(i);
+                _renderInfo[i] = ovrHmd_GetRenderDesc(hmd, eye, _FOV[i]);
+            }
+        } else {
+            const auto result = configureRendering(&getOvrGlConfig().Config, getDistortionCaps());
+            assert(result);
+            _distortion.configured = true;
+        }
+        ++_reconfigurations.rendering;
+        // The previous frame was rendered with a different configuration and cannot be reprojected.
+        _reprojection.valid = false;
+
+        // Mark the rendering configuration as sanitized.
+        _dirty.rendering = false;
+    } else if (_dirty.viewAdjust) {
+        // The eyes' offsets do not affect distortion correction, so they are updated
+        // without reconfiguring the SDK's renderer.
+        const Annotation annotation(isAnnotating(), _tracer, "sanitizeRenderingConfiguration (view adjust)");
+        for (unsigned int i = 0; i < ovrEye_Count; ++i) {
+            const auto& eye = static_cast<ovrEyeType>(i);
+            _renderInfo[i].ViewAdjust = ovrHmd_GetRenderDesc(hmd, eye, _FOV[i]).ViewAdjust;
+        }
+        ++_reconfigurations.viewAdjust;
+    }
+    if (reconfigure) {
         if (_forceZeroIPD) {
             for (auto& info : _renderInfo) {
                 info.ViewAdjust = OVR::Vector3f(0);
             }
         }
-        // Mark the rendering configuration as sanitized.
-        _dirty.rendering = false;
+        // The projections depend on each eye's FOV, render information and offset.
+        for (auto& dirty : _dirty.projections) {
+            dirty = true;
+        }
+        _dirty.viewAdjust = false;
+
+        // The eye buffers were rendered with a different configuration and cannot be reused.
+        _idle.valid = false;
     }
 }
 
@@ -712,15 +3031,10 @@ OVRWindow::resizeEvent(QResizeEvent* const e) {
 void
 OVRWindow::exposeEvent(QExposeEvent* const e) {
     // When the window is exposed the first time, it needs to be initialized.
+    // Note that an OVRWindow that renders offscreen is never initialized here.
     static bool isInitialized = false;
-    if (!isInitialized && isExposed()) {
-        _gl.setFormat(requestedFormat());
-        auto result = _gl.create();
-        assert(result);
-        makeCurrent();
-        assert(hasValidGL());
-        initializeOpenGLFunctions();
-        initializeGL();
+    if (!isInitialized && !isOffscreen() && isExposed()) {
+        initializeContext();
         configureGL();
         doneCurrent();
         requestUpdateGL();
@@ -734,6 +3048,13 @@ OVRWindow::exposeEvent(QExposeEvent* const e) {
 bool
 OVRWindow::event(QEvent* const e)
 {
+    // Input events are timestamped before they are dispatched to their handlers, where
+    // they may be consumed.
+    if (isInputEvent(e->type())) {
+        std::lock_guard<std::mutex> lock(_inputLatency.mutex);
+        const auto& event = ++_inputLatency.count;
+        _inputLatency.times[event % _inputLatency.times.size()] = ovr_GetTimeInSeconds();
+    }
     if (e->type() == QEvent::UpdateRequest) {
         _pendingUpdateRequest = false;
         updateGL();
@@ -794,5 +3115,18 @@ OVRWindow::getRenderTransforms(const ovrEyeType eye, const ovrPosef& pose) {
         }
         dirtyProjection = false;
     }
-    return transformations;
+
+    // While temporal upsampling is active, the projection is offset by the current frame's
+    // sub-pixel jitter so that successive frames sample different points in each pixel.
+    if (!_upsampling.active)
+        return transformations;
+
+    const auto& size = getOvrGlTexture(eye).OGL.Header.RenderViewport.Size;
+    QMatrix4x4 jitter;
+    jitter.translate(2.0f * _upsampling.jitter[0] / size.w, 2.0f * _upsampling.jitter[1] / size.h);
+
+    auto& jittered = _upsampling.transforms[eye];
+    jittered = transformations;
+    jittered.perspective = jitter * transformations.perspective;
+    return jittered;
 }
@@ -32,18 +32,40 @@
 #define OVRWINDOW_H
 #define GL_GLEXT_PROTOTYPES
 
+#include "OVRFrameExporter.h"
+#include "OVRGLFunctions.h"
+#include "OVRGLState.h"
+#include "OVRJobSystem.h"
+#include "OVROcclusionCuller.h"
+#include "OVRSensorSampler.h"
+#include "OVRTracer.h"
+#include "OVRUploadService.h"
 #include <OVR_CAPI.h>
 #include <QWindow>
 #include <QOpenGLFunctions>
 #include <QMatrix4x4>
+#include <QVector>
+#include <QImage>
+#include <QMap>
+#include <array>
+#include <mutex>
+#include <memory>
 
 
+class QOffscreenSurface;
+class QOpenGLFramebufferObject;
+class QOpenGLShaderProgram;
+class QPainter;
 union ovrGLConfig;
 union ovrGLTexture_s;
 typedef ovrGLTexture_s ovrGLTexture;
 
-class OVRWindow : public QWindow, protected QOpenGLFunctions {
+class OVRWindow : public QWindow, protected OVRGLFunctions {
 Q_OBJECT
+/**
+ * The benchmark suite (see tools/benchmark) measures some of the private hot paths.
+ */
+friend class OVRWindowBenchmark;
 public:
     /**
      * TODO Explain me better.
@@ -96,6 +118,36 @@ public:
         High,
         Highest
     };
+    /**
+     * @enum FrameExportSource
+     * @brief The image exported to shared memory: the render target (both undistorted eye
+     * buffers side by side), or the distorted output that is mirrored to the window.
+     */
+    enum class FrameExportSource {
+        EyeBuffers,
+        Mirror
+    };
+    /**
+     * @struct LODProfile
+     * @brief The configuration that is applied when a level of detail is selected.
+     *
+     * The horizontal and vertical FOV restrict the tangents of the device's default FOV
+     * (see clampFOV); zero leaves the FOV unrestricted. The alternateEyes and
+     * temporalUpsampling flags enable or disable alternate-eye rendering and temporal
+     * upsampling (see enableAlternateEyeRendering and enableTemporalUpsampling). Only the
+     * features listed in the features map are enabled or disabled, the others are left as
+     * they are.
+     */
+    struct LODProfile {
+        float pixelDensity;
+        float horizontalFOV;
+        float verticalFOV;
+        bool multisampling;
+        unsigned int distortionMeshDecimation;
+        bool alternateEyes;
+        bool temporalUpsampling;
+        QMap<OVRWindow::Feature, bool> features;
+    };
     /**
      * @struct RenderTransforms
      * @brief An object containing the view and projection transformation matrices.
@@ -107,6 +159,58 @@ public:
         QMatrix4x4 perspective;
         QMatrix4x4 ortho;
     };
+    /**
+     * @struct OffscreenFrame
+     * @brief A head pose and the time (in seconds) at which it was sampled.
+     *
+     * A sequence of offscreen frames drives the rendering loop when the OVRWindow
+     * renders without a visible window.
+     */
+    struct OffscreenFrame {
+        ovrPosef pose;
+        double time;
+    };
+    /**
+     * @struct LatencyStatistics
+     * @brief Motion-to-photon latency statistics (in seconds) over the most recent
+     * measurements, as well as the number of measurements they are computed from.
+     */
+    struct LatencyStatistics {
+        float mean;
+        float minimum;
+        float maximum;
+        float last;
+        unsigned int count;
+    };
+    /**
+     * @struct InputLatencyHistogram
+     * @brief A histogram of input-to-photon latencies. Each bin counts the latencies in
+     * [i * binWidth, (i + 1) * binWidth) seconds, save for the last bin, which also counts
+     * all greater latencies. The mean, minimum and maximum (in seconds) are computed from
+     * all counted latencies.
+     */
+    struct InputLatencyHistogram {
+        float binWidth;
+        QVector<unsigned int> bins;
+        unsigned int count;
+        float mean;
+        float minimum;
+        float maximum;
+    };
+    /**
+     * @struct ReconfigurationCounts
+     * @brief The number of times the render target was reallocated, the rendering
+     * configuration was fully updated, and only the eyes' offsets were updated, as well
+     * as the number of calls to ovrHmd_ConfigureRendering. A full update configures the
+     * SDK's renderer or, when the SDK does not correct the distortion, recomputes each
+     * eye's render description.
+     */
+    struct ReconfigurationCounts {
+        unsigned int renderTarget;
+        unsigned int rendering;
+        unsigned int viewAdjust;
+        unsigned int configureRendering;
+    };
     /**
      * @brief Instantiate an OVRWindow object that is attached to an Oculus Rift device.
      *
@@ -138,6 +242,162 @@ public:
      * @brief Return the OVRWindow's OpenGL context.
      */
     QOpenGLContext& getGL();
+    /**
+     * @brief Return the job system.
+     *
+     * The job system's workers are shared by the OVRWindow and its subclasses. Jobs are
+     * recycled right before updateFrame is called, so a frame's jobs may be started in
+     * updateFrame and waited on in paintGL. If updates are asynchronous, the previous
+     * frame's jobs are finished before the next update is started.
+     */
+    OVRJobSystem& getJobSystem();
+    /**
+     * @brief Return the background upload service.
+     *
+     * The service is created along with the OpenGL context, and may therefore be used from
+     * initializeGL onwards. Completed uploads are delivered at the start of each frame,
+     * before updateFrame is called.
+     */
+    OVRUploadService& getUploadService();
+    /**
+     * @brief Return the occlusion culling service, which is disabled by default.
+     *
+     * Occlusion queries are issued once the first eye in the device's render order has
+     * been painted, and their results are reused for the second eye, with the bounds
+     * dilated by the distance between the eyes and the near clipping distance. Objects
+     * that are not visible (see OVROcclusionCuller::isVisible) may be skipped in paintGL.
+     */
+    OVROcclusionCuller& getOcclusionCuller();
+    /**
+     * @brief Return the OpenGL state tracker.
+     *
+     * State changes made through the tracker in paintGL are only forwarded to OpenGL when
+     * they are not redundant. Unless the GL state synchronization is enabled, paintGL
+     * must change the tracked state (see OVRGLState) through the tracker only. The state
+     * changed by the SDK's distortion pass is invalidated, without being read back, and
+     * the tracked state is set again after each frame.
+     */
+    OVRGLState& getGLState();
+    /**
+     * Returns true if the GL state synchronization is enabled, false otherwise.
+     */
+    bool isGLStateSynchronizationEnabled() const;
+    /**
+     * @brief Enable or disable the GL state synchronization.
+     *
+     * Applications whose paintGL changes the tracked state (see OVRGLState) directly
+     * must enable the synchronization, which reads the tracked state back after each call
+     * to paintGL with about 15 glGet calls per eye, each of which may stall the pipeline.
+     * Otherwise, changing the tracked state directly leaves the tracker with a stale
+     * shadow copy.
+     * @param enable true to enable the synchronization, false to disable it.
+     */
+    void enableGLStateSynchronization(const bool enable = true);
+    /**
+     * Returns true if debug annotations are enabled, false otherwise.
+     */
+    bool isDebugAnnotationEnabled() const;
+    /**
+     * @brief Enable or disable debug annotations.
+     *
+     * When enabled, and if the OpenGL implementation supports KHR_debug, the sanitize
+     * steps that do work, each eye and the SDK's distortion pass are wrapped in debug
+     * groups, which are displayed by tools such as apitrace or RenderDoc. Note that the
+     * objects created by OVRWindow are labeled regardless.
+     * @param enable true to enable debug annotations, false to disable them.
+     */
+    void enableDebugAnnotations(const bool enable = true);
+    /**
+     * @brief Return the number of OpenGL calls made while the specified eye was painted
+     * during the previous frame.
+     *
+     * Calls are only counted if the project is configured with 'CONFIG += ovr_gl_call_counting',
+     * otherwise the counts are zero. See OVRGLFunctions.
+     * @param eye the eye to query.
+     */
+    const OVRGLCallCounts& getGLCallCounts(const ovrEyeType eye) const;
+    /**
+     * @brief Start recording a trace in the Chrome trace event format to the specified
+     * file, which can be opened with chrome://tracing or the Perfetto UI.
+     *
+     * The trace contains frames, eye passes (along with their GPU time), reconfigurations,
+     * the job system's jobs and LOD changes. The GPU's timestamps are converted to the
+     * trace's clock, so eye passes are placed on the GPU track when the GPU executed them.
+     * Returns false if the file could not be opened.
+     * @param path the file to write.
+     */
+    bool startTrace(const QString& path);
+    /**
+     * Stop recording the current trace.
+     */
+    void stopTrace();
+    /**
+     * Return the tracer, which may be used to add application events to the trace.
+     */
+    OVRTracer& getTracer();
+    /**
+     * @brief Return the motion-to-photon latency statistics.
+     *
+     * While the LatencyTesting feature is enabled, the SDK drives the latency tester during
+     * its distortion pass, and each result it reports is added to the statistics, which
+     * cover the 16 most recent measurements. If the OVRWindow is attached to a debug
+     * device, measurements are simulated instead (see isLatencySimulated).
+     */
+    const OVRWindow::LatencyStatistics& getLatencyStatistics() const;
+    /**
+     * @brief Returns true if latency measurements are simulated, false otherwise.
+     *
+     * Measurements are simulated when there is no physical device, and therefore no latency
+     * tester. A simulated measurement is made once per second, and is the time between the
+     * moment a frame's head pose is sampled and the predicted midpoint of its scanout.
+     */
+    bool isLatencySimulated() const;
+    /**
+     * @brief Return the sequence number of the most recent input event.
+     *
+     * Input events (keyboard, mouse, wheel, touch and tablet events) are timestamped when
+     * they arrive at the window, before they are dispatched to their handlers, and are
+     * numbered from 1 in order of arrival. Zero is returned if no input event was received.
+     * Like input event handlers, this function is called from the window's thread.
+     */
+    unsigned int getLastInputEvent() const;
+    /**
+     * @brief Tag the frame that is being prepared as the one that consumes an input event.
+     *
+     * When the frame is displayed, the time between the event's arrival and the frame's
+     * scanout is added to the input latency histogram. A tag made from an input event handler
+     * or from updateFrame applies to the next frame whose update is finished. Only the 64
+     * most recent events can be tagged, and each event is counted once. This function is
+     * thread-safe.
+     * @param event the event's sequence number (see getLastInputEvent).
+     */
+    void consumeInputEvent(const unsigned int event);
+    /**
+     * @brief Return the input-to-photon latency histogram.
+     *
+     * Offscreen frames have no scanout, so they are considered to be displayed as soon as
+     * they are rendered.
+     */
+    const OVRWindow::InputLatencyHistogram& getInputLatencyHistogram() const;
+    /**
+     * @brief Clear the input latency histogram.
+     */
+    void resetInputLatencyHistogram();
+    /**
+     * @brief Return the sensor sampler.
+     *
+     * Once started, the sampler records the head pose at a high rate on its own thread,
+     * so that it can be queried from any thread at any time, rather than only from paintGL.
+     */
+    OVRSensorSampler& getSensorSampler();
+    /**
+     * @brief Return the number of reconfigurations of each kind since the OVRWindow was
+     * instantiated.
+     *
+     * Changing the IPD only updates the eyes' offsets, whereas changing the FOV, the
+     * distortion features or multisampling reconfigures the SDK's renderer.
+     */
+    const OVRWindow::ReconfigurationCounts& getReconfigurationCounts() const;
     /**
      * @brief Return the Oculus Rift's information.
      */
@@ -189,12 +449,50 @@ public:
      * @param lod the level of detail to set.
      */
     void setLOD(const OVRWindow::LOD lod);
+    /**
+     * Return the profile that is applied when the specified level of detail is selected.
+     * @param lod the level of detail to query.
+     */
+    const OVRWindow::LODProfile& getLODProfile(const OVRWindow::LOD lod) const;
+    /**
+     * Set the profile that is applied when the specified level of detail is selected. If
+     * the level of detail is the current one, the profile is applied immediately.
+     * @param lod the level of detail whose profile is set.
+     * @param profile the profile to set.
+     */
+    void setLODProfile(const OVRWindow::LOD lod, const OVRWindow::LODProfile& profile);
+    /**
+     * @brief Load the levels of detail's profiles from a JSON file.
+     *
+     * The file contains an object whose keys are level names ("Lowest", "Low", "Medium",
+     * "High" and "Highest"), each of which overrides some or all of the level's settings:
+     *
+     *     {
+     *         "Low": {
+     *             "pixelDensity": 0.5,
+     *             "fov": [1.0, 1.0],
+     *             "multisampling": false,
+     *             "distortionMeshDecimation": 4,
+     *             "alternateEyes": false,
+     *             "temporalUpsampling": true,
+     *             "features": {"ChromaticAberrationCorrection": false}
+     *         }
+     *     }
+     *
+     * Feature names are those of the Feature enumeration. The profiles are left unchanged
+     * and false is returned if the file cannot be read or is invalid. Otherwise, the
+     * current level's profile is applied.
+     * @param path the file to load.
+     */
+    bool loadLODProfiles(const QString& path);
     /**
      * Return the current interpupillary distance (IPD) in millimeters.
      */
     float getIPD() const;
     /**
-     * Set the interpupillary distance (IPD) in millimeters.
+     * Set the interpupillary distance (IPD) in millimeters. Only the eyes' offsets and
+     * the transformation matrices that depend on them are updated, so the IPD may be
+     * changed every frame.
      * @param ipd the distance to set.
      */
     void setIPD(const float ipd);
@@ -210,6 +508,37 @@ public:
      * TODO Explain me.
      */
     void setPixelDensity(const float density);
+    /**
+     * Return the specified eye's field of view (FOV), as the tangents of its half-angles.
+     * @param eye the eye to query.
+     */
+    const ovrFovPort& getFOV(const ovrEyeType eye) const;
+    /**
+     * @brief Set the specified eye's field of view (FOV).
+     *
+     * The tangents may be asymmetric, and are clamped to the device's maximum FOV. The
+     * render target is resized to the new FOV before the next frame, so narrowing the FOV
+     * reduces the number of pixels that are rendered.
+     * @param eye the eye whose FOV is set.
+     * @param fov the FOV to set.
+     */
+    void setFOV(const ovrEyeType eye, const ovrFovPort& fov);
+    /**
+     * Set both eyes' FOV. The specified FOV is the left eye's, and the right eye's FOV
+     * is its mirror image.
+     * @param fov the left eye's FOV.
+     */
+    void setFOV(const ovrFovPort& fov);
+    /**
+     * Restrict both eyes' default FOV to the specified tangents.
+     * @param horizontal the maximum tangent of the left and right half-angles.
+     * @param vertical the maximum tangent of the up and down half-angles.
+     */
+    void clampFOV(const float horizontal, const float vertical);
+    /**
+     * Restore both eyes' default FOV.
+     */
+    void resetFOV();
     /**
      * Return the viewing frustum's near clipping plane distance.
      */
@@ -237,6 +566,326 @@ public:
      * @param enable true to enable multisampling, false to disable.
      */
     void enableMultisampling(const bool enable = true);
+    /**
+     * Returns true if the OVRWindow renders to an offscreen surface, false otherwise.
+     */
+    bool isOffscreen() const;
+    /**
+     * @brief Render a sequence of frames without a visible window.
+     *
+     * If the window has never been shown, the first call to this function creates an
+     * offscreen surface and an OpenGL context (calling initializeGL), after which the
+     * OVRWindow permanently renders offscreen. Otherwise, the window's context is used,
+     * and the window keeps presenting its own frames. Each frame is painted into the
+     * render target with the same paintGL path used by the windowed mode, except that
+     * the head pose and frame time are supplied by the caller. Distortion correction is
+     * always skipped, since both the SDK's and the OVRWindow's distortion passes render
+     * to a window; the render target holds the undistorted eye buffers (see
+     * grabRenderTarget). Frames are rendered back to back, as fast as the GPU allows,
+     * and offscreenFrameRendered is emitted after each one.
+     *
+     * Note that a QGuiApplication is still required, although a windowless platform
+     * plugin (e.g. '-platform offscreen') may be used.
+     * @param frames the sequence of head poses and timestamps to render.
+     */
+    void renderOffscreen(const QVector<OVRWindow::OffscreenFrame>& frames);
+    /**
+     * @brief Read back the render target's contents, i.e. both eye buffers.
+     *
+     * This function must be called while the OVRWindow's OpenGL context is current,
+     * e.g. from a slot directly connected to the offscreenFrameRendered signal.
+     */
+    QImage grabRenderTarget();
+    /**
+     * Returns true if the heads-up display (HUD) is enabled, false otherwise.
+     */
+    bool isHUDEnabled() const;
+    /**
+     * @brief Enable or disable the heads-up display (HUD).
+     *
+     * The HUD is a 2D layer that is drawn by paintHUD into a cached texture, then
+     * composited into each eye's view with the eye's orthographic projection (see
+     * RenderTransforms::ortho) after paintGL returns. The texture is only redrawn
+     * when updateHUD is called, or periodically if a refresh interval is set.
+     * @param enable true to enable the HUD, false to disable it.
+     */
+    void enableHUD(const bool enable = true);
+    /**
+     * Return the HUD's resolution in pixels.
+     */
+    const QSize& getHUDResolution() const;
+    /**
+     * Set the HUD's resolution in pixels. The HUD is centered in each eye's view and
+     * one HUD pixel covers one pixel of the orthographic projection.
+     * @param resolution the resolution to set.
+     */
+    void setHUDResolution(const QSize& resolution);
+    /**
+     * Return the interval (in seconds) at which the HUD is redrawn.
+     */
+    float getHUDRefreshInterval() const;
+    /**
+     * Set the interval (in seconds) at which the HUD is redrawn. If the interval is
+     * zero, the HUD is only redrawn when updateHUD is called.
+     * @param interval the interval to set.
+     */
+    void setHUDRefreshInterval(const float interval);
+    /**
+     * Returns true if reprojection is enabled, false otherwise.
+     */
+    bool isReprojectionEnabled() const;
+    /**
+     * @brief Enable or disable reprojection.
+     *
+     * When reprojection is enabled, the eye buffers and head pose of the previous frame
+     * are kept. Before an eye is painted, the time paintGL is expected to take is compared
+     * to the time left before the frame's deadline; if the deadline would be missed,
+     * paintGL is skipped and the eye's previous image is reprojected to the current head
+     * orientation instead. An eye is never reprojected twice in a row.
+     *
+     * Note that the expected paint time is measured on the CPU.
+     * @param enable true to enable reprojection, false to disable it.
+     */
+    void enableReprojection(const bool enable = true);
+    /**
+     * Return the frame time budget in seconds.
+     */
+    float getFrameTimeBudget() const;
+    /**
+     * Set the frame time budget, i.e. the time (in seconds) the eyes may take to render,
+     * after which the remaining eyes are reprojected. If the budget is zero, the deadline
+     * is the point at which the SDK starts its distortion pass.
+     * @param budget the budget to set.
+     */
+    void setFrameTimeBudget(const float budget);
+    /**
+     * Return the number of frames in which at least one eye was reprojected.
+     */
+    unsigned int getReprojectedFrameCount() const;
+    /**
+     * Returns true if alternate-eye rendering is enabled, false otherwise.
+     */
+    bool isAlternateEyeRenderingEnabled() const;
+    /**
+     * @brief Enable or disable alternate-eye rendering.
+     *
+     * When alternate-eye rendering is enabled, only one eye is painted per frame, in
+     * turns. The other eye's previous image is reprojected to the current head orientation
+     * instead (see enableReprojection), and both eye buffers are submitted to the SDK as
+     * usual. This roughly halves the cost of paintGL at the expense of image quality,
+     * and is enabled by the lowest level of detail's default profile.
+     * @param enable true to enable alternate-eye rendering, false to disable it.
+     */
+    void enableAlternateEyeRendering(const bool enable = true);
+    /**
+     * Returns true if temporal upsampling is enabled, false otherwise.
+     */
+    bool isTemporalUpsamplingEnabled() const;
+    /**
+     * @brief Enable or disable temporal upsampling.
+     *
+     * While temporal upsampling is enabled and the pixel density is below 1, the
+     * perspective projection returned by getRenderTransforms is offset by a sub-pixel
+     * jitter that changes every frame. Each eye's image is then accumulated into a
+     * full-resolution (i.e. a pixel density of 1) buffer, into which the previous output
+     * is reprojected to the current head orientation and clamped to the current image's
+     * neighborhood to limit ghosting. The full-resolution buffer is what is distorted.
+     * This recovers much of the clarity lost to a low pixel density, for the cost of one
+     * full-screen pass per eye. It is enabled by the lower levels of detail's default
+     * profiles.
+     * @param enable true to enable temporal upsampling, false to disable it.
+     */
+    void enableTemporalUpsampling(const bool enable = true);
+    /**
+     * Returns true if updateFrame is called asynchronously, false otherwise.
+     */
+    bool isAsynchronousUpdateEnabled() const;
+    /**
+     * @brief Enable or disable asynchronous frame updates.
+     *
+     * When enabled, updateFrame is called by the job system as soon as the eyes have been
+     * painted, so that it runs in parallel with the SDK's distortion pass and the GPU's
+     * work. The rendering thread waits for it to return before the next frame is painted.
+     * @param enable true to enable asynchronous updates, false to disable them.
+     */
+    void enableAsynchronousUpdate(const bool enable = true);
+    /**
+     * The uniform buffer binding point at which the transform buffer is published.
+     */
+    static constexpr GLuint TransformBufferBinding = 0;
+    /**
+     * Returns true if the transform buffer is enabled, false otherwise.
+     */
+    bool isTransformBufferEnabled() const;
+    /**
+     * @brief Enable or disable the transform buffer.
+     *
+     * When enabled, the current eye's transformation matrices are published to a uniform
+     * buffer bound to TransformBufferBinding before paintGL is called, so that shader
+     * programs can share them instead of uploading them individually. The uniform block
+     * is declared as follows:
+     *
+     *     layout(std140) uniform OVRTransforms {
+     *         mat4 view;
+     *         mat4 projection;
+     *         mat4 viewProjection;
+     *         mat4 ortho;
+     *     };
+     *
+     * The buffer holds both eyes' matrices for each frame slot (see getFrameSlot), and is
+     * persistently mapped when the OpenGL implementation supports it (ARB_buffer_storage).
+     * A frame's matrices are never overwritten while the GPU may still read them, since a
+     * slot is only reused once the frame that last used it is finished.
+     * @param enable true to enable the transform buffer, false to disable it.
+     */
+    void enableTransformBuffer(const bool enable = true);
+    /**
+     * Bind a shader program's transform uniform block to TransformBufferBinding.
+     * @param program the shader program's handle.
+     * @param name the uniform block's name.
+     */
+    void bindTransformBlock(const GLuint program, const char* const name = "OVRTransforms");
+    /**
+     * The number of frame slots, i.e. the largest number of frames that may be in flight.
+     */
+    static constexpr unsigned int FrameSlotCount = 3;
+    /**
+     * Return the maximum number of frames in flight.
+     */
+    unsigned int getMaximumFramesInFlight() const;
+    /**
+     * @brief Set the maximum number of frames in flight, i.e. the number of frames whose
+     * commands the GPU may still be executing when the CPU starts preparing a new frame.
+     *
+     * A fence is inserted after each frame's commands. Once a frame has been updated, and
+     * before its eyes are painted, the CPU waits for the frames that would exceed the
+     * maximum to finish. A maximum of 1 keeps the CPU and GPU in lockstep, which minimizes
+     * latency, while higher values let the CPU prepare a frame while the GPU executes the
+     * previous ones. The maximum is clamped to [1, FrameSlotCount] and is 2 by default.
+     * @param maximum the maximum to set.
+     */
+    void setMaximumFramesInFlight(const unsigned int maximum);
+    /**
+     * @brief Return the current frame's slot in [0, FrameSlotCount).
+     *
+     * Per-frame resources that the GPU reads or writes, such as uniform buffers or
+     * readback buffers, may be indexed by slot: when a frame is painted, the GPU has
+     * finished the previous frame that had the same slot.
+     */
+    unsigned int getFrameSlot() const;
+    /**
+     * Returns true if lens distortion is corrected by the OVRWindow rather than the SDK,
+     * false otherwise.
+     */
+    bool isClientDistortionEnabled() const;
+    /**
+     * @brief Enable or disable client-side distortion correction.
+     *
+     * When enabled, the SDK's distortion renderer (ovrHmd_EndFrame) is not used. Instead,
+     * each eye's distortion mesh is built with ovrHmd_CreateDistortionMesh, uploaded once
+     * to static buffers and rendered by the OVRWindow, which then swaps the window's
+     * buffers itself. The meshes are only rebuilt when the FOV or the mesh decimation is
+     * changed. The ChromaticAberrationCorrection, Timewarp and Vignette features select
+     * which corrections are applied by the distortion shader, so toggling them does not
+     * rebuild the meshes. While the latency tester is running, its quad is drawn after
+     * the meshes.
+     * @param enable true to enable client-side distortion correction, false to disable it.
+     */
+    void enableClientDistortion(const bool enable = true);
+    /**
+     * Return the distortion mesh decimation.
+     */
+    unsigned int getDistortionMeshDecimation() const;
+    /**
+     * @brief Set the distortion mesh decimation, i.e. the number of grid cells in each
+     * direction that are merged into one when client-side distortion is enabled.
+     *
+     * A decimation of 1 renders the full mesh. Higher values reduce the number of
+     * vertices that are transformed, at the cost of a less accurate correction.
+     * @param decimation the decimation to set.
+     */
+    void setDistortionMeshDecimation(const unsigned int decimation);
+    /**
+     * Returns true if idle mode is enabled, false otherwise.
+     */
+    bool isIdleModeEnabled() const;
+    /**
+     * @brief Enable or disable idle mode.
+     *
+     * In idle mode, if the scene is marked as clean (see markSceneClean) and the head has
+     * moved less than the idle threshold since the eye buffers were rendered, the eyes
+     * are not painted. Instead, the previous eye buffers are submitted to distortion
+     * correction again, along with the pose they were rendered with, so that timewarp
+     * compensates for the head's motion. A reconfiguration, a HUD redraw or a change to
+     * the projections forces the eyes to be repainted. Note that updateFrame is still
+     * called every frame.
+     * @param enable true to enable idle mode, false to disable it.
+     */
+    void enableIdleMode(const bool enable = true);
+    /**
+     * Return the idle threshold.
+     */
+    float getIdleThreshold() const;
+    /**
+     * Set the idle threshold, i.e. how far the head may move before the eyes are repainted.
+     * The head's motion is the angle (in radians) it has rotated by plus the distance (in
+     * meters) it has moved, which is roughly how far a point one meter away appears to move.
+     * @param threshold the threshold to set.
+     */
+    void setIdleThreshold(const float threshold);
+    /**
+     * Returns true if the scene is marked as clean, false otherwise.
+     */
+    bool isSceneClean() const;
+    /**
+     * @brief Mark the scene as clean, i.e. unchanged since the eyes were last painted, or
+     * as dirty.
+     *
+     * The mark persists until it is changed, so an application marks its scene as dirty
+     * whenever it changes (e.g. in updateFrame), and as clean once it stops changing. If
+     * asynchronous updates are enabled, this must be called from swapFrameState.
+     * @param clean true to mark the scene as clean, false to mark it as dirty.
+     */
+    void markSceneClean(const bool clean = true);
+    /**
+     * Return the number of frames whose eye buffers were reused in idle mode.
+     */
+    unsigned int getReusedFrameCount() const;
+    /**
+     * Returns true if frames are exported to shared memory, false otherwise.
+     */
+    bool isFrameExportEnabled() const;
+    /**
+     * @brief Enable or disable the export of completed frames to POSIX shared memory, so
+     * that they can be read by other processes (see OVRFrameExporter).
+     *
+     * Each frame is read back into a pixel buffer object that is only mapped once the
+     * frame slot is reused (see getFrameSlot), so that the render loop never waits for a
+     * readback, then copied into the shared memory ring. Readers are never waited for
+     * either. The ring is created when the first frame is exported, and is recreated if
+     * the frames outgrow it. The eye buffers are exported as they are submitted to the
+     * SDK, i.e. at the upsampled resolution when temporal upsampling is active. The
+     * mirrored output can only be read back when client distortion is enabled. If the
+     * ring cannot be created, or if the mirrored output is exported in SDK distortion
+     * mode, the export fails and stops until it is enabled again (see
+     * hasFrameExportFailed).
+     * @param enable true to enable the export, false to disable it.
+     * @param name the shared memory object's name.
+     * @param source the image to export.
+     */
+    void enableFrameExport(
+        const bool enable,
+        const QString& name = "OVRWindow",
+        const OVRWindow::FrameExportSource source = OVRWindow::FrameExportSource::EyeBuffers
+    );
+    /**
+     * Returns true if the frame export failed and stopped, false otherwise.
+     */
+    bool hasFrameExportFailed() const;
+    /**
+     * Return the number of frames that were exported to shared memory.
+     */
+    unsigned long long getExportedFrameCount() const;
 protected:
     /**
      * @brief Initialize OpenGL.
@@ -247,6 +896,25 @@ protected:
      * @brief This virtual function is called whenever a new frame needs to be rendered.
      */
     virtual void paintGL(const ovrEyeType eye, const OVRWindow::RenderTransforms& transforms, const float dt);
+    /**
+     * @brief This virtual function is called once per frame, before the eyes are painted.
+     *
+     * Per-frame logic such as simulation or animation belongs here rather than in paintGL,
+     * which is called once per eye. If asynchronous updates are enabled, this function is
+     * called on a worker thread and must not make OpenGL calls; state that is read by
+     * paintGL should be written to a back buffer and published in swapFrameState.
+     * @param dt the time elapsed since the previous frame.
+     * @param frameTiming the frame's timing information. If asynchronous updates are enabled,
+     * dt and frameTiming are those of the frame that was just painted, from which the timing
+     * of the next frame can be predicted.
+     */
+    virtual void updateFrame(const float dt, const ovrFrameTiming& frameTiming);
+    /**
+     * @brief This virtual function is called on the rendering thread once updateFrame has
+     * returned, right before the eyes are painted. It is used to hand the state produced by
+     * updateFrame over to paintGL, e.g. by swapping a double-buffered state.
+     */
+    virtual void swapFrameState();
     /**
      * @brief This virtual function is called whenever the window is resized.
      *
@@ -265,9 +933,20 @@ protected:
     /**
      * @brief This virtual function is called whenever the level of detail (LOD) is changed.
      *
+     * The default implementation applies the level's profile. Since each setting only
+     * marks a configuration as outdated, the whole profile is applied in a single
+     * reconfiguration before the next frame.
      * @param lod the new level of detail.
      */
     virtual void changeLOD(const OVRWindow::LOD lod);
+    /**
+     * @brief This virtual function is called whenever the HUD needs to be redrawn.
+     *
+     * The painter draws into the HUD's texture which has been cleared to transparent.
+     * @param painter the painter used to draw the HUD.
+     * @param resolution the HUD's resolution.
+     */
+    virtual void paintHUD(QPainter& painter, const QSize& resolution);
 private:
     /**
      * Updates the window.
@@ -286,6 +965,171 @@ private:
      * TODO Explain me.
      */
     void paintGL();
+    /**
+     * Paint a single eye's view into its render target viewport.
+     * @param eye the eye to paint.
+     * @param pose the head pose.
+     * @param dt the time elapsed since the previous frame.
+     */
+    void paintEye(const ovrEyeType eye, const ovrPosef& pose, const float dt);
+    /**
+     * Create the OpenGL context, make it current and initialize it.
+     */
+    void initializeContext();
+    /**
+     * Returns true if debug groups are pushed onto the command stream, false otherwise.
+     */
+    bool isAnnotating() const;
+    /**
+     * Label an OpenGL object, if KHR_debug is supported.
+     * @param identifier the object's namespace, e.g. GL_TEXTURE.
+     * @param name the object's name.
+     * @param label the label to set.
+     */
+    void labelObject(const GLenum identifier, const GLuint name, const char* const label);
+    /**
+     * Begin an eye's pass: the pass is annotated, timed on the GPU if a trace is being
+     * recorded, and its OpenGL calls are counted if call counting is enabled.
+     * @param eye the eye that is about to be painted or reprojected.
+     */
+    void beginEyePass(const ovrEyeType eye);
+    /**
+     * End an eye's pass.
+     * @param eye the eye that was painted or reprojected.
+     */
+    void endEyePass(const ovrEyeType eye);
+    /**
+     * Record the GPU timings of previous frames' eye passes whose results are available.
+     */
+    void collectGPUTimers();
+    /**
+     * Collect the latency tester's result, or simulate a measurement, if latency testing
+     * is enabled.
+     * @param frameTiming the timing of the frame that was just finished.
+     */
+    void measureLatency(const ovrFrameTiming& frameTiming);
+    /**
+     * Make the input events tagged since the previous frame's update the current frame's.
+     */
+    void swapInputEvents();
+    /**
+     * Add the latencies of the input events consumed by the current frame to the histogram.
+     * @param scanoutTime the time at which the frame is displayed.
+     */
+    void measureInputLatency(const double scanoutTime);
+    /**
+     * Redraw the HUD's texture if it is outdated.
+     * @param time the current time in seconds.
+     */
+    void sanitizeHUD(const double time);
+    /**
+     * Composite the HUD into the current eye's view.
+     * @param transforms the eye's transformation matrices.
+     */
+    void compositeHUD(const OVRWindow::RenderTransforms& transforms);
+    /**
+     * Bind the OVRWindow's own vertex array object through the tracker, so that the
+     * vertex attributes set up to draw the OVRWindow's quads and meshes do not affect
+     * the application's vertex arrays. This must be done within a state scope.
+     */
+    void bindVertexArray();
+    /**
+     * Returns true if the specified eye should be reprojected instead of painted.
+     * @param eye the eye to query.
+     * @param deadline the time (in seconds) by which the frame must be rendered.
+     */
+    bool isReprojectionRequired(const ovrEyeType eye, const double deadline) const;
+    /**
+     * Returns true if the specified eye is not painted in the current frame because of
+     * alternate-eye rendering, in which case it is reprojected.
+     * @param eye the eye to query.
+     */
+    bool isEyeAlternated(const ovrEyeType eye) const;
+    /**
+     * Returns true if the render target's history buffer is required, i.e. if reprojection
+     * or alternate-eye rendering is enabled.
+     */
+    bool isRenderTargetHistoryRequired() const;
+    /**
+     * Reproject the specified eye's previous image to the current head orientation.
+     * @param eye the eye to reproject.
+     * @param pose the current head pose.
+     */
+    void reprojectEye(const ovrEyeType eye, const ovrPosef& pose);
+    /**
+     * Returns true if the previous frame's eye buffers can be reused in idle mode.
+     * @param pose the current head pose of the first eye to be rendered.
+     */
+    bool isFrameReusable(const ovrPosef& pose) const;
+    /**
+     * Prepare the previous frame's eye buffers to be submitted again.
+     */
+    void reuseFrame();
+    /**
+     * Read the current frame back into its slot's pixel buffer, if frames are exported.
+     * @param frameTiming the frame's timing information.
+     */
+    void readBackExportedFrame(const ovrFrameTiming& frameTiming);
+    /**
+     * Copy the frame that was read back into the current frame slot's pixel buffer, if
+     * any, into the shared memory ring.
+     */
+    void publishExportedFrame();
+    /**
+     * Swap the render target's pixel buffer with the previous frame's.
+     */
+    void swapRenderTargetHistory();
+    /**
+     * Allocate or resize the full-resolution buffers used by temporal upsampling if need
+     * be, and advance the sub-pixel jitter.
+     */
+    void sanitizeUpsampling();
+    /**
+     * Accumulate an eye's image into the full-resolution output buffer.
+     * @param eye the eye to upsample.
+     * @param pose the head pose the eye's image was rendered with.
+     */
+    void upsampleEye(const ovrEyeType eye, const ovrPosef& pose);
+    /**
+     * Allocate the transform buffer if need be.
+     */
+    void sanitizeTransformBuffer();
+    /**
+     * Write an eye's transformation matrices to the transform buffer and bind them.
+     * @param eye the eye whose matrices are published.
+     * @param transforms the eye's transformation matrices.
+     */
+    void publishTransforms(const ovrEyeType eye, const OVRWindow::RenderTransforms& transforms);
+    /**
+     * Begin a new frame in the next frame slot, waiting for the GPU to finish the frames
+     * that would exceed the maximum number of frames in flight.
+     */
+    void acquireFrameSlot();
+    /**
+     * Insert a fence after the current frame's commands.
+     */
+    void releaseFrameSlot();
+    /**
+     * Rebuild the distortion meshes if they are outdated and client-side distortion is enabled.
+     */
+    void sanitizeDistortionMeshes();
+    /**
+     * Correct the render target's distortion into the window's framebuffer, then draw the
+     * latency tester's quad, if need be.
+     * @param frameTiming the frame's timing information.
+     */
+    void renderDistortion(const ovrFrameTiming& frameTiming);
+    /**
+     * Finish the job system's pending jobs, record their timings, then recycle them.
+     */
+    void beginJobFrame();
+    /**
+     * Make sure the frame has been updated, beginning a new frame of jobs first if the
+     * update is not already done, then publish the updated state.
+     * @param dt the time elapsed since the previous frame.
+     * @param frameTiming the frame's timing information.
+     */
+    void synchronizeFrameUpdate(const float dt, const ovrFrameTiming& frameTiming);
     /**
      * TODO Explain me.
      */
@@ -294,6 +1138,12 @@ private:
      * TODO Explain me.
      */
     ovrGLTexture& getOvrGlTexture(const ovrEyeType eye) const;
+    /**
+     * Return the texture that is distorted for the specified eye, i.e. the full-resolution
+     * output buffer while temporal upsampling is active, the render target otherwise.
+     * @param eye the eye whose texture is returned.
+     */
+    ovrGLTexture& getSubmittedOvrGlTexture(const ovrEyeType eye) const;
     /**
      * Update an outdated render target configuration.
      */
@@ -339,6 +1189,16 @@ private:
      * The OpenGL context.
      */
     QOpenGLContext _gl;
+    /**
+     * The offscreen rendering state: the surface, which is only instantiated when the
+     * OVRWindow renders offscreen, the time of the previous offscreen frame, and whether
+     * an offscreen frame was rendered.
+     */
+    struct {
+        std::unique_ptr<QOffscreenSurface> surface;
+        double time;
+        bool started;
+    } _offscreen;
     /**
      * TODO Explain me.
      */
@@ -349,6 +1209,7 @@ private:
     struct {
         GLuint fbo;
         GLuint pixel;
+        GLuint history;
         GLuint depth;
         QSize resolution;
     } _renderTarget;
@@ -388,15 +1249,244 @@ private:
      * The interface's level of detail.
      */
     OVRWindow::LOD _LOD;
+    /**
+     * The profile of each level of detail.
+     */
+    QVector<OVRWindow::LODProfile> _LODProfiles;
     /**
      * This set of variables keeps track of dirty configurations.
      */
     struct {
         bool renderTarget;
         bool rendering;
+        bool viewAdjust;
         struct { bool hmd, sensor; } device;
         bool projections[ovrEye_Count];
     } _dirty;
+    /**
+     * The number of reconfigurations of each kind.
+     */
+    OVRWindow::ReconfigurationCounts _reconfigurations;
+    /**
+     * The heads-up display (HUD) and the resources used to cache and composite it.
+     */
+    struct {
+        bool enabled;
+        bool dirty;
+        QSize resolution;
+        float refreshInterval;
+        double refreshTime;
+        GLuint vbo;
+        std::unique_ptr<QOpenGLFramebufferObject> framebuffer;
+        std::unique_ptr<QOpenGLShaderProgram> program;
+    } _HUD;
+    /**
+     * The reprojection configuration, statistics, and the resources used to reproject
+     * an eye's previous image. The previous image is stored in the render target's
+     * history buffer.
+     */
+    struct {
+        bool enabled;
+        bool valid;
+        float budget;
+        unsigned int count;
+        bool reprojected[ovrEye_Count];
+        double paintDuration[ovrEye_Count];
+        ovrPosef poses[ovrEye_Count];
+        GLuint vbo;
+        std::unique_ptr<QOpenGLShaderProgram> program;
+    } _reprojection;
+    /**
+     * The alternate-eye rendering configuration, and the eye that is painted in the
+     * current frame.
+     */
+    struct {
+        bool enabled;
+        ovrEyeType eye;
+    } _alternateEye;
+    /**
+     * The temporal upsampling configuration and resources: whether upsampling is active in
+     * the current frame, whether the most recent output is valid, the index of the output
+     * buffer that holds it (the other is written next), the output buffers, their
+     * framebuffer objects and resolution, the number of frames that drive the jitter
+     * sequence, the current frame's jitter (in pixels), the pose each eye was last
+     * upsampled with, the jittered render transforms, and the resources used to resolve
+     * an eye.
+     */
+    struct {
+        bool enabled;
+        bool active;
+        bool valid;
+        unsigned int current;
+        GLuint textures[2];
+        GLuint fbos[2];
+        QSize resolution;
+        unsigned int frame;
+        float jitter[2];
+        ovrPosef poses[ovrEye_Count];
+        OVRWindow::RenderTransforms transforms[ovrEye_Count];
+        GLuint vbo;
+        GLuint sampler;
+        std::unique_ptr<QOpenGLShaderProgram> program;
+    } _upsampling;
+    /**
+     * The transform buffer, which holds a region for each frame slot. Each region contains
+     * one uniform block per eye, aligned to the implementation's uniform buffer offset
+     * alignment. If the buffer is persistently mapped, mapping points to its first byte.
+     */
+    struct {
+        bool enabled;
+        GLuint buffer;
+        GLint stride;
+        GLubyte* mapping;
+    } _transformBuffer;
+    /**
+     * The frames in flight: the maximum number of frames in flight, the current frame's
+     * index, and the fence inserted after the commands of each slot's last frame.
+     */
+    struct {
+        unsigned int maximum;
+        unsigned int index;
+        std::array<GLsync, OVRWindow::FrameSlotCount> fences;
+    } _frames;
+    /**
+     * The client-side distortion configuration, and the resources used to render each
+     * eye's distortion mesh. The configured flag is set while the SDK's distortion
+     * renderer is configured, and poses holds the head pose each eye was rendered with.
+     */
+    struct {
+        bool enabled;
+        bool dirty;
+        bool configured;
+        unsigned int decimation;
+        std::array<GLuint, ovrEye_Count> vbo;
+        std::array<GLuint, ovrEye_Count> ibo;
+        std::array<GLsizei, ovrEye_Count> indexCount;
+        GLuint sampler;
+        ovrPosef poses[ovrEye_Count];
+        std::unique_ptr<QOpenGLShaderProgram> program;
+    } _distortion;
+    /**
+     * The idle mode configuration: whether the scene is clean, whether the eye buffers
+     * are valid (i.e. hold a complete frame rendered with the current configuration),
+     * whether the previous frame was reused, the idle threshold and the number of
+     * reused frames.
+     */
+    struct {
+        bool enabled;
+        bool sceneClean;
+        bool valid;
+        bool reused;
+        float threshold;
+        unsigned int count;
+    } _idle;
+    /**
+     * The frame export configuration, the shared memory ring and whether it could not be
+     * created, each frame slot's pixel buffer and the description of the frame it holds,
+     * if any, and the number of frames exported.
+     */
+    struct {
+        bool enabled;
+        QString name;
+        OVRWindow::FrameExportSource source;
+        std::unique_ptr<OVRFrameExporter> exporter;
+        bool failed;
+        std::array<GLuint, OVRWindow::FrameSlotCount> buffers;
+        std::array<OVRFrameExporter::Frame, OVRWindow::FrameSlotCount> frames;
+        std::array<bool, OVRWindow::FrameSlotCount> pending;
+        unsigned long long count;
+    } _export;
+    /**
+     * The job system.
+     */
+    OVRJobSystem _jobs;
+    /**
+     * The background upload service. It is declared after the OpenGL context so that it
+     * is destroyed first.
+     */
+    std::unique_ptr<OVRUploadService> _uploadService;
+    /**
+     * The occlusion culling service.
+     */
+    OVROcclusionCuller _occlusionCuller;
+    /**
+     * The OpenGL state tracker.
+     */
+    OVRGLState _glState;
+    /**
+     * This flag is set if the tracked state is read back after each call to paintGL.
+     */
+    bool _synchronizeGLState;
+    /**
+     * The vertex array object used to draw the OVRWindow's quads and meshes.
+     */
+    GLuint _vertexArray;
+    /**
+     * The debugging configuration: whether KHR_debug is supported, whether debug groups
+     * are enabled, and each eye's OpenGL call counts.
+     */
+    struct {
+        bool supported;
+        bool enabled;
+        std::array<OVRGLCallCounts, ovrEye_Count> callCounts;
+    } _debug;
+    /**
+     * The trace recorder.
+     */
+    OVRTracer _tracer;
+    /**
+     * The timer queries that measure each eye's GPU time while a trace is recorded, and
+     * the timestamp queries that record the GPU time at which each eye started. There is
+     * a set of queries for each of the last three frames, so results can be collected
+     * without waiting for the GPU.
+     */
+    struct {
+        std::array<std::array<GLuint, ovrEye_Count>, 3> queries;
+        std::array<std::array<GLuint, ovrEye_Count>, 3> timestamps;
+        std::array<std::array<bool, ovrEye_Count>, 3> pending;
+        unsigned int frame;
+        bool active;
+    } _gpuTimers;
+    /**
+     * The latency measurements: whether they are simulated, the time of the last simulated
+     * measurement, the time at which the current frame's head pose was sampled, the most
+     * recent measurements and the statistics computed from them.
+     */
+    struct {
+        bool simulated;
+        double simulationTime;
+        double sampleTime;
+        QVector<float> measurements;
+        unsigned int next;
+        OVRWindow::LatencyStatistics statistics;
+    } _latency;
+    /**
+     * The input latency measurements: the arrival times of the most recent input events,
+     * the number of received events, the arrival times of the events that were tagged since
+     * the previous frame's update and of those consumed by the current frame, the histogram
+     * and the sum of its latencies. The mutex protects the events' times and tags.
+     */
+    struct {
+        std::mutex mutex;
+        std::array<double, 64> times;
+        unsigned int count;
+        QVector<double> tagged;
+        QVector<double> consumed;
+        OVRWindow::InputLatencyHistogram histogram;
+        double sum;
+    } _inputLatency;
+    /**
+     * The sensor sampler.
+     */
+    std::unique_ptr<OVRSensorSampler> _sensorSampler;
+    /**
+     * The frame update state. If asynchronous updates are enabled, the job is non-null
+     * while an update is pending.
+     */
+    struct {
+        bool asynchronous;
+        OVRJobSystem::Job* job;
+    } _update;
 public slots:
     /**
      * @brief Toggle vision modes.
@@ -414,6 +1504,10 @@ public slots:
      * @brief Toggle multisampling.
      */
     void toggleMultisampling();
+    /**
+     * @brief Mark the HUD as outdated so that it is redrawn before the next frame.
+     */
+    void updateHUD();
 signals:
     /**
      * This signal is emitted when the interface has been correctly initialized and is ready for use.
@@ -424,6 +1518,17 @@ signals:
      * @param currentLOD the interface's current level of detail.
      */
     void LODChanged(const OVRWindow::LOD currentLOD);
+    /**
+     * This signal is emitted after an offscreen frame has been rendered, while the
+     * OpenGL context is still current and the render target is still bound.
+     * @param index the frame's index in the sequence passed to renderOffscreen.
+     */
+    void offscreenFrameRendered(const unsigned int index);
+    /**
+     * This signal is emitted when a motion-to-photon latency measurement is made.
+     * @param latency the measured latency in seconds.
+     */
+    void latencyMeasured(const float latency);
 };
 
 #endif // OVRWINDOW_H
@@ -0,0 +1,21 @@
+# OVRWindow source, relative to this file so that it can be included from any project.
+INCLUDEPATH += $$PWD
+HEADERS += \
+    $$PWD/OVRWindow.h \
+    $$PWD/OVRFrameExporter.h \
+    $$PWD/OVRGLFunctions.h \
+    $$PWD/OVRGLState.h \
+    $$PWD/OVRJobSystem.h \
+    $$PWD/OVROcclusionCuller.h \
+    $$PWD/OVRSensorSampler.h \
+    $$PWD/OVRTracer.h \
+    $$PWD/OVRUploadService.h
+SOURCES += \
+    $$PWD/OVRWindow.cpp \
+    $$PWD/OVRFrameExporter.cpp \
+    $$PWD/OVRGLState.cpp \
+    $$PWD/OVRJobSystem.cpp \
+    $$PWD/OVROcclusionCuller.cpp \
+    $$PWD/OVRSensorSampler.cpp \
+    $$PWD/OVRTracer.cpp \
+    $$PWD/OVRUploadService.cpp
@@ -15,6 +15,9 @@ QT += gui-private
 # Add modern C++ support.
 CONFIG += c++14
 
+# Count the OpenGL calls made per eye (see OVRGLFunctions.h).
+ovr_gl_call_counting: DEFINES += OVR_GL_CALL_COUNTING
+
 # Common build configuration.
 INCLUDEPATH += $$LIBOVR/Include $$LIBOVR/Src
 LIBS += -lovr
@@ -23,5 +26,5 @@ LIBS += -lovr
 unix:!macx {
    eval(QMAKE_HOST.arch = x86_64): LIBS += -L$$LIBOVR/Lib/Linux/Release/x86_64
    else:                           LIBS += -L$$LIBOVR/Lib/Linux/Release/i386
-                                   LIBS += -lX11 -lXinerama -lXrandr -ludev
+                                   LIBS += -lX11 -lXinerama -lXrandr -ludev -lrt
 }
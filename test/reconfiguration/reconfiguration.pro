@@ -0,0 +1,21 @@
+# Path to the OVRWindow source code tree.
+OVRWINDOW = ../../src
+
+# OVRWindow configuration.
+include($$OVRWINDOW/ovrwindow.pri)
+
+# OVRWindow source.
+include($$OVRWINDOW/ovrwindow-sources.pri)
+
+# The test's build configuration.
+TEMPLATE = app
+TARGET = tst_reconfiguration
+QT += testlib
+CONFIG += console testcase
+DESTDIR = build
+UI_DIR = $$DESTDIR/ui
+MOC_DIR = $$DESTDIR/moc
+OBJECTS_DIR = $$DESTDIR/obj
+QMAKE_CXXFLAGS += -Wall -Wextra
+LIBS += -lpthread
+SOURCES += tst_reconfiguration.cpp
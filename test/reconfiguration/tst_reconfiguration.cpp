@@ -0,0 +1,206 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * Checks that each configuration change only does the work it requires: changing the
+ * IPD only updates the eyes' offsets, whereas changing the FOV, the pixel density, the
+ * distortion features or multisampling reconfigures the SDK's renderer, which is
+ * verified by counting the calls to ovrHmd_ConfigureRendering.
+ *
+ * The window is shown so that the SDK performs distortion correction, and is attached to
+ * the debug device when no Rift is connected. The SDK's OpenGL configuration requires an
+ * X display, so the test is run under a virtual one (e.g. xvfb-run) on headless machines.
+ */
+#include <OVRWindow.h>
+#include <QGuiApplication>
+#include <QtTest>
+#include <memory>
+
+
+/**
+ * An OVRWindow that counts the frames it renders.
+ */
+class TestWindow : public OVRWindow {
+public:
+    /**
+     * The number of frames that were rendered.
+     */
+    unsigned int frames = 0;
+protected:
+    void swapFrameState() override {
+        ++frames;
+    }
+};
+
+
+class ReconfigurationTest : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void setIPD();
+    void forceZeroIPD();
+    void setFOV();
+    void setPixelDensity();
+    void enableFeature();
+    void enableMultisampling();
+private:
+    /**
+     * Wait until the window has rendered a frame, which applies the pending configuration
+     * changes.
+     */
+    void renderFrame();
+    /**
+     * Render a frame, then check that rendering was fully reconfigured, and that
+     * ovrHmd_ConfigureRendering was called, exactly once since the specified counts.
+     * @param before the counts before the configuration was changed.
+     */
+    void verifyReconfigured(const OVRWindow::ReconfigurationCounts& before);
+    /**
+     * The window under test. Only one OVRWindow may be instantiated.
+     */
+    std::unique_ptr<TestWindow> _window;
+};
+
+
+void
+ReconfigurationTest::initTestCase() {
+    _window.reset(new TestWindow);
+    _window->show();
+    QVERIFY(QTest::qWaitForWindowExposed(_window.get()));
+
+    // The first frame applies the initial configuration, which configures the SDK's
+    // distortion renderer.
+    renderFrame();
+    QVERIFY(_window->getReconfigurationCounts().configureRendering > 0);
+}
+
+
+void
+ReconfigurationTest::cleanupTestCase() {
+    _window.reset();
+}
+
+
+void
+ReconfigurationTest::setIPD() {
+    const OVRWindow::ReconfigurationCounts before = _window->getReconfigurationCounts();
+    _window->setIPD(_window->getIPD() + 0.002f);
+    renderFrame();
+
+    const auto& after = _window->getReconfigurationCounts();
+    QCOMPARE(after.configureRendering, before.configureRendering);
+    QCOMPARE(after.rendering, before.rendering);
+    QCOMPARE(after.viewAdjust, before.viewAdjust + 1);
+}
+
+
+void
+ReconfigurationTest::forceZeroIPD() {
+    for (const auto& force : {true, false}) {
+        const OVRWindow::ReconfigurationCounts before = _window->getReconfigurationCounts();
+        _window->forceZeroIPD(force);
+        renderFrame();
+
+        const auto& after = _window->getReconfigurationCounts();
+        QCOMPARE(after.configureRendering, before.configureRendering);
+        QCOMPARE(after.rendering, before.rendering);
+        QCOMPARE(after.viewAdjust, before.viewAdjust + 1);
+    }
+}
+
+
+void
+ReconfigurationTest::setFOV() {
+    const OVRWindow::ReconfigurationCounts before = _window->getReconfigurationCounts();
+    const ovrFovPort fov = _window->getFOV(ovrEye_Left);
+    _window->setFOV(ovrEye_Left, {0.9f * fov.UpTan, 0.9f * fov.DownTan, 0.9f * fov.LeftTan, 0.9f * fov.RightTan});
+    verifyReconfigured(before);
+    QCOMPARE(_window->getReconfigurationCounts().viewAdjust, before.viewAdjust);
+
+    _window->setFOV(ovrEye_Left, fov);
+    renderFrame();
+}
+
+
+void
+ReconfigurationTest::setPixelDensity() {
+    const OVRWindow::ReconfigurationCounts before = _window->getReconfigurationCounts();
+    const auto density = _window->getPixelDensity();
+    _window->setPixelDensity(0.5f * density);
+    verifyReconfigured(before);
+    QCOMPARE(_window->getReconfigurationCounts().renderTarget, before.renderTarget + 1);
+
+    _window->setPixelDensity(density);
+    renderFrame();
+}
+
+
+void
+ReconfigurationTest::enableFeature() {
+    const auto& feature = OVRWindow::Feature::Vignette;
+    const auto enabled = _window->isFeatureEnabled(feature);
+    for (const auto& enable : {!enabled, enabled}) {
+        const OVRWindow::ReconfigurationCounts before = _window->getReconfigurationCounts();
+        _window->enableFeature(feature, enable);
+        verifyReconfigured(before);
+    }
+}
+
+
+void
+ReconfigurationTest::enableMultisampling() {
+    const auto enabled = _window->isMultisamplingEnabled();
+    for (const auto& enable : {!enabled, enabled}) {
+        const OVRWindow::ReconfigurationCounts before = _window->getReconfigurationCounts();
+        _window->enableMultisampling(enable);
+        verifyReconfigured(before);
+    }
+}
+
+
+void
+ReconfigurationTest::renderFrame() {
+    const auto frames = _window->frames;
+    QTRY_VERIFY(_window->frames > frames);
+}
+
+
+void
+ReconfigurationTest::verifyReconfigured(const OVRWindow::ReconfigurationCounts& before) {
+    renderFrame();
+
+    const auto& after = _window->getReconfigurationCounts();
+    QCOMPARE(after.configureRendering, before.configureRendering + 1);
+    QCOMPARE(after.rendering, before.rendering + 1);
+}
+
+
+int main(int argc, char** argv) {
+    QGuiApplication application(argc, argv);
+    ReconfigurationTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+
+#include "tst_reconfiguration.moc"
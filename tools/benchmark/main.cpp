@@ -0,0 +1,305 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * The benchmark suite measures the CPU cost of OVRWindow's hot paths, i.e. the work the
+ * library adds to each frame on top of the application's rendering, and writes the
+ * results as JSON so that they can be compared across revisions.
+ *
+ * The OVRWindow renders offscreen so that no window is shown, and is attached to the
+ * debug device when no Rift is connected. Each benchmark is run in samples of a fixed
+ * number of iterations, and the time per iteration (in nanoseconds) of each sample is
+ * recorded. The sanitize functions are measured both when their configuration is up
+ * to date (clean) and when it is marked as outdated (dirty). Since the OVRWindow renders
+ * offscreen, rendering is configured with ovrHmd_GetRenderDesc rather than
+ * ovrHmd_ConfigureRendering.
+ *
+ * Finally, a key press is sent to the OVRWindow before each of a sequence of offscreen
+ * frames, which consumes it, and the resulting input latency histogram (in milliseconds)
+ * is written alongside the results. Offscreen frames are not scanned out, so this only
+ * covers the latency added by the CPU and the GPU.
+ *
+ * Usage: benchmark [--samples N] [--iterations I] [--output FILE]
+ */
+#include <OVRWindow.h>
+#include <QGuiApplication>
+#include <QKeyEvent>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+
+
+/**
+ * The benchmark suite's configuration.
+ */
+struct Options {
+    unsigned int samples = 50;
+    unsigned int iterations = 1000;
+    QString output;
+};
+
+
+/**
+ * A benchmark's result: the mean, median and minimum time per iteration in nanoseconds.
+ */
+struct Result {
+    const char* name;
+    double mean;
+    double median;
+    double minimum;
+};
+
+
+/**
+ * The measured functions' results are written here so that they are not optimized away.
+ */
+static volatile float SINK = 0.0f;
+
+
+/**
+ * The benchmarks. This class is a friend of OVRWindow so that private functions can be measured.
+ */
+class OVRWindowBenchmark {
+public:
+    OVRWindowBenchmark(OVRWindow& window, const Options& options) : _window(window), _options(options) {}
+    /**
+     * Run all benchmarks.
+     */
+    QVector<Result> run();
+private:
+    /**
+     * Measure the time per iteration of a function. A first sample warms up the caches
+     * and brings the OVRWindow's state up to date, and is discarded.
+     */
+    template<typename Function>
+    Result measure(const char* const name, Function function) const {
+        using namespace std::chrono;
+        const auto& iterations = _options.iterations;
+        for (unsigned int i = 0; i < iterations; ++i) {
+            function();
+        }
+        QVector<double> samples;
+        samples.reserve(_options.samples);
+        for (unsigned int s = 0; s < _options.samples; ++s) {
+            const auto& start = steady_clock::now();
+            for (unsigned int i = 0; i < iterations; ++i) {
+                function();
+            }
+            const auto& end = steady_clock::now();
+            samples.append(duration<double, std::nano>(end - start).count() / iterations);
+        }
+        std::sort(samples.begin(), samples.end());
+        return {
+            name,
+            std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size(),
+            samples[samples.size() / 2],
+            samples.first()
+        };
+    }
+    OVRWindow& _window;
+    const Options& _options;
+};
+
+
+/**
+ * Parse the command-line arguments. Returns false if an argument is invalid.
+ */
+bool
+parseOptions(const int argc, char** const argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* const argument = argv[i];
+        const char* const value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr)
+            return false;
+
+        if (!std::strcmp(argument, "--samples"))
+            options.samples = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(argument, "--iterations"))
+            options.iterations = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(argument, "--output"))
+            options.output = QString(value);
+        else
+            return false;
+        ++i;
+    }
+    return options.samples > 0 && options.iterations > 0;
+}
+
+
+/**
+ * Render a sequence of offscreen frames, each consuming a key press sent right before it,
+ * to fill the input latency histogram.
+ */
+void
+measureInputLatency(OVRWindow& window, const Options& options) {
+    const ovrPosef pose = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+    window.resetInputLatencyHistogram();
+    for (unsigned int i = 0; i < options.samples; ++i) {
+        QKeyEvent event(QEvent::KeyPress, Qt::Key_Space, Qt::NoModifier);
+        QCoreApplication::sendEvent(&window, &event);
+        window.consumeInputEvent(window.getLastInputEvent());
+        window.renderOffscreen({{pose, i / 75.0}});
+    }
+}
+
+
+/**
+ * Write the results as a JSON document.
+ */
+void
+writeResults(std::FILE* const file, const OVRWindow& window, const Options& options, const QVector<Result>& results) {
+    std::fprintf(file, "{\n");
+    std::fprintf(file, "    \"device\": \"%s\",\n", window.getDeviceInfo().ProductName);
+    std::fprintf(file, "    \"samples\": %u,\n", options.samples);
+    std::fprintf(file, "    \"iterations\": %u,\n", options.iterations);
+    std::fprintf(file, "    \"unit\": \"ns\",\n");
+    std::fprintf(file, "    \"results\": [\n");
+    for (int i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        std::fprintf(
+            file,
+            "        {\"name\": \"%s\", \"mean\": %.2f, \"median\": %.2f, \"minimum\": %.2f}%s\n",
+            result.name, result.mean, result.median, result.minimum, i + 1 < results.size() ? "," : ""
+        );
+    }
+    std::fprintf(file, "    ],\n");
+
+    const auto& histogram = window.getInputLatencyHistogram();
+    std::fprintf(file, "    \"inputLatency\": {\n");
+    std::fprintf(file, "        \"unit\": \"ms\",\n");
+    std::fprintf(file, "        \"binWidth\": %.2f,\n", 1000.0 * histogram.binWidth);
+    std::fprintf(file, "        \"count\": %u,\n", histogram.count);
+    std::fprintf(file, "        \"mean\": %.2f,\n", 1000.0 * histogram.mean);
+    std::fprintf(file, "        \"minimum\": %.2f,\n", 1000.0 * histogram.minimum);
+    std::fprintf(file, "        \"maximum\": %.2f,\n", 1000.0 * histogram.maximum);
+    std::fprintf(file, "        \"bins\": [");
+    for (int i = 0; i < histogram.bins.size(); ++i) {
+        std::fprintf(file, "%u%s", histogram.bins[i], i + 1 < histogram.bins.size() ? ", " : "");
+    }
+    std::fprintf(file, "]\n");
+    std::fprintf(file, "    }\n");
+    std::fprintf(file, "}\n");
+}
+
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "Usage: %s [--samples N] [--iterations I] [--output FILE]\n", argv[0]);
+        return 1;
+    }
+
+    // No window is shown, so a display is not required.
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication application(argc, argv);
+    OVRWindow window;
+
+    // Create the OpenGL context without rendering any frame.
+    window.renderOffscreen(QVector<OVRWindow::OffscreenFrame>());
+
+    const auto& results = OVRWindowBenchmark(window, options).run();
+    measureInputLatency(window, options);
+    std::FILE* const file = options.output.isEmpty() ? stdout : std::fopen(qPrintable(options.output), "w");
+    if (file == nullptr) {
+        std::fprintf(stderr, "Could not open '%s'.\n", qPrintable(options.output));
+        return 1;
+    }
+    writeResults(file, window, options, results);
+    if (file != stdout)
+        std::fclose(file);
+
+    return 0;
+}
+
+
+QVector<Result>
+OVRWindowBenchmark::run() {
+    auto& window = _window;
+    const ovrPosef pose = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+    QVector<Result> results;
+
+    // The transformation matrices, with and without recomputing the projections.
+    window.makeCurrent();
+    results << measure("getRenderTransforms (clean)", [&]() {
+        SINK = window.getRenderTransforms(ovrEye_Left, pose).view(0, 0);
+    });
+    results << measure("getRenderTransforms (dirty)", [&]() {
+        window._dirty.projections[ovrEye_Left] = true;
+        SINK = window.getRenderTransforms(ovrEye_Left, pose).perspective(0, 0);
+    });
+
+    // Feature queries and toggles. The feature's state is restored afterwards.
+    const auto& feature = OVRWindow::Feature::Vignette;
+    const bool enabled = window.isFeatureEnabled(feature);
+    bool enable = !enabled;
+    results << measure("isFeatureEnabled", [&]() {
+        SINK = window.isFeatureEnabled(feature);
+    });
+    results << measure("enableFeature", [&]() {
+        window.enableFeature(feature, enable);
+        enable = !enable;
+    });
+    window.enableFeature(feature, enabled);
+
+    // The sanitize functions, when their configuration is up to date or outdated.
+    results << measure("sanitizeRenderTargetConfiguration (clean)", [&]() {
+        window.sanitizeRenderTargetConfiguration();
+    });
+    results << measure("sanitizeRenderTargetConfiguration (dirty)", [&]() {
+        window._dirty.renderTarget = true;
+        window.sanitizeRenderTargetConfiguration();
+    });
+    results << measure("sanitizeDeviceConfiguration (clean)", [&]() {
+        window.sanitizeDeviceConfiguration();
+    });
+    results << measure("sanitizeDeviceConfiguration (dirty)", [&]() {
+        window._dirty.device.hmd = true;
+        window._dirty.device.sensor = true;
+        window.sanitizeDeviceConfiguration();
+    });
+    results << measure("sanitizeRenderingConfiguration (clean)", [&]() {
+        window.sanitizeRenderingConfiguration();
+    });
+    results << measure("sanitizeRenderingConfiguration (dirty)", [&]() {
+        window._dirty.rendering = true;
+        window.sanitizeRenderingConfiguration();
+    });
+    results << measure("sanitizeRenderingConfiguration (view adjust)", [&]() {
+        window._dirty.viewAdjust = true;
+        window.sanitizeRenderingConfiguration();
+    });
+    window.doneCurrent();
+
+    // An update request's round trip through the event loop. Since the OVRWindow is not
+    // exposed, the frame is not painted.
+    results << measure("requestUpdateGL", [&]() {
+        window.requestUpdateGL();
+        QCoreApplication::sendPostedEvents(&window, QEvent::UpdateRequest);
+    });
+    return results;
+}
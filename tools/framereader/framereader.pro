@@ -0,0 +1,20 @@
+# Path to the OVRWindow source code tree.
+OVRWINDOW = ../../src
+
+# The frame reader only depends on the shared memory protocol, not on LibOVR.
+CONFIG += c++14
+INCLUDEPATH += $$OVRWINDOW
+HEADERS += $$OVRWINDOW/OVRFrameExporter.h
+SOURCES += $$OVRWINDOW/OVRFrameExporter.cpp
+
+# The frame reader's build configuration.
+TEMPLATE = app
+TARGET = framereader
+CONFIG += console
+DESTDIR = build
+UI_DIR = $$DESTDIR/ui
+MOC_DIR = $$DESTDIR/moc
+OBJECTS_DIR = $$DESTDIR/obj
+QMAKE_CXXFLAGS += -Wall -Wextra
+LIBS += -lrt
+SOURCES += main.cpp
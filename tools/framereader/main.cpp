@@ -0,0 +1,215 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * The frame reader is a reference reader for the frames an OVRWindow exports to shared
+ * memory (see OVRWindow::enableFrameExport). It follows the most recent frame, reports
+ * each frame's index, time and head pose, as well as the frames it missed or that were
+ * overwritten while they were read, and optionally writes the frames to disk as PNG images.
+ *
+ * Pixels are read in place from the shared memory object, so only the frames that are
+ * written to disk are copied. If the OVRWindow recreates the shared memory object, the
+ * reader opens the new one.
+ *
+ * Usage: framereader [--name NAME] [--frames N] [--output DIRECTORY]
+ */
+#include <OVRFrameExporter.h>
+#include <QCoreApplication>
+#include <QDir>
+#include <QImage>
+#include <QThread>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+/**
+ * The frame reader's configuration. If the number of frames is zero, frames are read
+ * until the reader is interrupted.
+ */
+struct Options {
+    QString name = "OVRWindow";
+    unsigned int frames = 0;
+    QString output;
+};
+
+
+/**
+ * A read-only mapping of an exported shared memory object.
+ */
+struct Mapping {
+    OVRFrameExporter::Header* header = nullptr;
+    std::size_t size = 0;
+};
+
+
+/**
+ * Parse the command-line arguments. Returns false if an argument is invalid.
+ */
+bool
+parseOptions(const int argc, char** const argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* const argument = argv[i];
+        const char* const value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr)
+            return false;
+
+        if (!std::strcmp(argument, "--name"))
+            options.name = QString(value);
+        else if (!std::strcmp(argument, "--frames"))
+            options.frames = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(argument, "--output"))
+            options.output = QString(value);
+        else
+            return false;
+        ++i;
+    }
+    return !options.name.isEmpty();
+}
+
+
+/**
+ * Map the shared memory object with the specified name. Returns false if the object does
+ * not exist (yet), or if it does not follow the expected protocol.
+ */
+bool
+openMapping(const QString& name, Mapping& mapping) {
+    const auto& objectName = (name.startsWith("/") ? name : QString("/") + name).toLocal8Bit();
+    const auto& descriptor = shm_open(objectName.constData(), O_RDONLY, 0);
+    if (descriptor < 0)
+        return false;
+
+    struct stat status;
+    void* address = MAP_FAILED;
+    if (fstat(descriptor, &status) == 0 && static_cast<std::size_t>(status.st_size) >= sizeof(OVRFrameExporter::Header))
+        address = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+    close(descriptor);
+    if (address == MAP_FAILED)
+        return false;
+
+    auto* const header = static_cast<OVRFrameExporter::Header*>(address);
+    const auto& size = static_cast<std::size_t>(status.st_size);
+    if (std::memcmp(header->magic, OVRFrameExporter::Magic, sizeof(header->magic)) ||
+        header->version != OVRFrameExporter::Version ||
+        OVRFrameExporter::getSize(header->slotCount, header->capacity) > size) {
+        munmap(address, size);
+        return false;
+    }
+    mapping = {header, size};
+    return true;
+}
+
+
+/**
+ * Unmap a shared memory object.
+ */
+void
+closeMapping(Mapping& mapping) {
+    if (mapping.header != nullptr) {
+        munmap(mapping.header, mapping.size);
+        mapping = Mapping();
+    }
+}
+
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "Usage: %s [--name NAME] [--frames N] [--output DIRECTORY]\n", argv[0]);
+        return 1;
+    }
+    QCoreApplication application(argc, argv);
+    const QDir output(options.output);
+    if (!options.output.isEmpty() && !QDir().mkpath(options.output)) {
+        std::fprintf(stderr, "Could not create the output directory '%s'.\n", qPrintable(options.output));
+        return 1;
+    }
+
+    Mapping mapping;
+    unsigned long long next = 0;
+    unsigned int read = 0;
+    unsigned long long missed = 0;
+    unsigned long long overwritten = 0;
+    while (options.frames == 0 || read < options.frames) {
+        // Wait for the shared memory object to be (re)created.
+        if (mapping.header == nullptr || mapping.header->closed.load(std::memory_order_acquire)) {
+            closeMapping(mapping);
+            if (!openMapping(options.name, mapping)) {
+                QThread::msleep(100);
+                continue;
+            }
+            next = 0;
+        }
+
+        // Only the most recent frame is read. Frames written since the previous one was
+        // read are counted as missed.
+        auto* const header = mapping.header;
+        const auto& count = header->count.load(std::memory_order_acquire);
+        if (count <= next) {
+            QThread::msleep(1);
+            continue;
+        }
+        missed += count - 1 - next;
+        next = count;
+
+        // Read the frame in place, then make sure its slot was not overwritten meanwhile,
+        // in which case the frame is dropped. The sequence number expected for the frame
+        // is derived from its index in the ring, as it is incremented twice per write.
+        const auto& slotIndex = static_cast<unsigned int>((count - 1) % header->slotCount);
+        const auto& slot = *OVRFrameExporter::getSlot(header, slotIndex);
+        const auto& expected = static_cast<std::uint32_t>(2 * ((count - 1) / header->slotCount + 1));
+        if (slot.sequence.load(std::memory_order_acquire) != expected) {
+            ++overwritten;
+            continue;
+        }
+        const auto frame = slot.frame;
+        QImage image;
+        if (!options.output.isEmpty()) {
+            const auto* const pixels = OVRFrameExporter::getPixels(header, slotIndex);
+            image = QImage(pixels, frame.width, frame.height, frame.stride, QImage::Format_RGBA8888).mirrored();
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != expected) {
+            ++overwritten;
+            continue;
+        }
+        if (!image.isNull())
+            image.save(output.filePath(QString::asprintf("frame%06llu.png", static_cast<unsigned long long>(frame.index))));
+
+        const auto& q = frame.poses[0].orientation;
+        const auto& p = frame.poses[0].position;
+        std::printf(
+            "frame %llu: %.4fs %ux%u orientation (%.3f, %.3f, %.3f, %.3f) position (%.3f, %.3f, %.3f)\n",
+            static_cast<unsigned long long>(frame.index), frame.time, frame.width, frame.height,
+            q[0], q[1], q[2], q[3], p[0], p[1], p[2]
+        );
+        ++read;
+    }
+    closeMapping(mapping);
+    std::printf("%u frames read, %llu missed, %llu overwritten while read.\n", read, missed, overwritten);
+    return 0;
+}
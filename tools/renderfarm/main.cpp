@@ -0,0 +1,421 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * The render farm renders a camera path as a sequence of stereo frames (both eye buffers
+ * side by side) and writes them to disk as PNG images.
+ *
+ * Since an OVRWindow is bound to a single device and only one instance may exist per
+ * process, the camera path is split into contiguous segments that are rendered by
+ * worker processes, each with its own offscreen OpenGL context. Within a worker, the
+ * renderer hands frames to a pool of encoder threads through a bounded queue: when the
+ * encoders fall behind, the renderer blocks until a slot frees up. When no GPU is
+ * available, the workers fall back to Mesa's software rasterizer.
+ *
+ * Usage: renderfarm [--frames N] [--fps F] [--workers W] [--encoders E] [--queue Q]
+ *                   [--output DIRECTORY] [--software]
+ */
+#include <OVRWindow.h>
+#include <QGuiApplication>
+#include <QProcess>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QThread>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+/**
+ * The render farm's configuration.
+ */
+struct Options {
+    unsigned int frames = 750;
+    double fps = 75.0;
+    unsigned int workers = 0;
+    unsigned int encoders = 2;
+    unsigned int queueDepth = 8;
+    QString output = "frames";
+    bool software = false;
+    int segment = -1;
+};
+
+
+/**
+ * A first-in first-out queue with a bounded capacity. Pushing an element into a full
+ * queue blocks until an element is popped, which applies backpressure on the producer.
+ */
+template<typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(const std::size_t capacity) : _capacity(capacity), _closed(false) {}
+    /**
+     * Push an element into the queue, blocking while the queue is full.
+     */
+    void push(T&& value) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _notFull.wait(lock, [this]() { return _queue.size() < _capacity; });
+        _queue.push(std::move(value));
+        _notEmpty.notify_one();
+    }
+    /**
+     * Pop an element from the queue, blocking while the queue is empty. Returns false
+     * if the queue is empty and has been closed, true otherwise.
+     */
+    bool pop(T& value) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _notEmpty.wait(lock, [this]() { return _closed || !_queue.empty(); });
+        if (_queue.empty())
+            return false;
+
+        value = std::move(_queue.front());
+        _queue.pop();
+        _notFull.notify_one();
+        return true;
+    }
+    /**
+     * Close the queue, waking up all consumers once the remaining elements are popped.
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _closed = true;
+        _notEmpty.notify_all();
+    }
+private:
+    const std::size_t _capacity;
+    bool _closed;
+    std::queue<T> _queue;
+    std::mutex _mutex;
+    std::condition_variable _notEmpty;
+    std::condition_variable _notFull;
+};
+
+
+/**
+ * A rendered frame waiting to be written to disk.
+ */
+struct EncodeJob {
+    QImage image;
+    unsigned int index;
+};
+
+
+/**
+ * The scene rendered by each worker: a ring of lit cubes around the viewer.
+ */
+class StereoRenderer : public OVRWindow {
+protected:
+    void initializeGL() override final;
+    void paintGL(const ovrEyeType, const OVRWindow::RenderTransforms&, const float) override final;
+};
+
+
+/**
+ * Returns the head pose at the specified time along the camera path. The head sweeps
+ * around the vertical axis while nodding gently.
+ */
+ovrPosef
+getCameraPose(const double time) {
+    const auto& yaw = 0.5 * time;
+    const auto& pitch = 0.2 * std::sin(time);
+    const auto& cy = std::cos(0.5 * yaw);
+    const auto& sy = std::sin(0.5 * yaw);
+    const auto& cp = std::cos(0.5 * pitch);
+    const auto& sp = std::sin(0.5 * pitch);
+
+    ovrPosef pose;
+    pose.Orientation.x = static_cast<float>(cy * sp);
+    pose.Orientation.y = static_cast<float>(sy * cp);
+    pose.Orientation.z = static_cast<float>(-sy * sp);
+    pose.Orientation.w = static_cast<float>(cy * cp);
+    pose.Position.x = 0.0f;
+    pose.Position.y = 0.0f;
+    pose.Position.z = 0.0f;
+    return pose;
+}
+
+
+/**
+ * Returns true if the machine has no hardware rendering device.
+ */
+bool
+isGPUMissing() {
+    return QDir("/dev/dri").entryList(QStringList() << "renderD*", QDir::System).isEmpty();
+}
+
+
+/**
+ * Parse the command-line arguments. Returns false if an argument is invalid.
+ */
+bool
+parseOptions(const int argc, char** const argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* const argument = argv[i];
+        const char* const value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!std::strcmp(argument, "--software")) {
+            options.software = true;
+            continue;
+        }
+        if (value == nullptr)
+            return false;
+
+        if (!std::strcmp(argument, "--frames"))
+            options.frames = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(argument, "--fps"))
+            options.fps = std::strtod(value, nullptr);
+        else if (!std::strcmp(argument, "--workers"))
+            options.workers = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(argument, "--encoders"))
+            options.encoders = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(argument, "--queue"))
+            options.queueDepth = std::strtoul(value, nullptr, 10);
+        else if (!std::strcmp(argument, "--output"))
+            options.output = QString(value);
+        else if (!std::strcmp(argument, "--segment"))
+            options.segment = std::atoi(value);
+        else
+            return false;
+        ++i;
+    }
+    if (options.workers == 0)
+        options.workers = std::max(1, QThread::idealThreadCount());
+
+    // A worker's segment must be one of the workers' segments.
+    if (options.segment >= static_cast<int>(options.workers))
+        return false;
+
+    return options.frames > 0 && options.fps > 0.0 && options.encoders > 0 && options.queueDepth > 0;
+}
+
+
+/**
+ * Render a segment of the camera path and write its frames to disk.
+ */
+int
+runWorker(const Options& options) {
+    const auto& segment = static_cast<unsigned int>(options.segment);
+    const auto& begin = segment * options.frames / options.workers;
+    const auto& end = (segment + 1) * options.frames / options.workers;
+
+    QVector<OVRWindow::OffscreenFrame> path;
+    path.reserve(end - begin);
+    for (auto i = begin; i < end; ++i) {
+        const auto& time = i / options.fps;
+        path.append({getCameraPose(time), time});
+    }
+
+    // Start the encoders.
+    const QDir output(options.output);
+    BoundedQueue<EncodeJob> queue(options.queueDepth);
+    std::vector<std::thread> encoders;
+    std::atomic<unsigned int> failures(0);
+    for (unsigned int i = 0; i < options.encoders; ++i) {
+        encoders.emplace_back([&queue, &output, &failures]() {
+            EncodeJob job;
+            while (queue.pop(job)) {
+                const auto& path = output.filePath(QString::asprintf("frame%06u.png", job.index));
+                if (!job.image.save(path)) {
+                    std::fprintf(stderr, "Could not write '%s'.\n", qPrintable(path));
+                    ++failures;
+                }
+            }
+        });
+    }
+
+    // Render the segment, handing each frame to the encoders. The time spent waiting
+    // for a free slot in the queue is the time the renderer is throttled by the encoders.
+    StereoRenderer renderer;
+    qint64 blocked = 0;
+    QObject::connect(&renderer, &OVRWindow::offscreenFrameRendered, [&](const unsigned int i) {
+        EncodeJob job{renderer.grabRenderTarget(), begin + i};
+        QElapsedTimer timer;
+        timer.start();
+        queue.push(std::move(job));
+        blocked += timer.nsecsElapsed();
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    renderer.renderOffscreen(path);
+    queue.close();
+    for (auto& encoder : encoders) {
+        encoder.join();
+    }
+    const auto& seconds = timer.nsecsElapsed() * 1e-9;
+
+    std::printf(
+        "worker %u: %u frames in %.2f s (%.1f fps), %.2f s blocked on encoders\n",
+        segment, end - begin, seconds, (end - begin) / seconds, blocked * 1e-9
+    );
+    return failures > 0 ? 1 : 0;
+}
+
+
+/**
+ * Spawn a worker process for each segment of the camera path and report their throughput.
+ */
+int
+runCoordinator(const Options& options, const QStringList& arguments) {
+    if (!QDir().mkpath(options.output)) {
+        std::fprintf(stderr, "Could not create the output directory '%s'.\n", qPrintable(options.output));
+        return 1;
+    }
+
+    // Workers render without a display. If software rasterization is used, the cores
+    // are divided among the workers rather than oversubscribed by each one.
+    auto environment = QProcessEnvironment::systemEnvironment();
+    if (!environment.contains("QT_QPA_PLATFORM"))
+        environment.insert("QT_QPA_PLATFORM", "offscreen");
+
+    const bool software = options.software || isGPUMissing();
+    if (software) {
+        const auto& threads = std::max(1, QThread::idealThreadCount() / static_cast<int>(options.workers));
+        environment.insert("LIBGL_ALWAYS_SOFTWARE", "1");
+        environment.insert("GALLIUM_DRIVER", "llvmpipe");
+        environment.insert("LP_NUM_THREADS", QString::number(threads));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    std::vector<std::unique_ptr<QProcess>> workers;
+    for (unsigned int i = 0; i < options.workers; ++i) {
+        std::unique_ptr<QProcess> worker(new QProcess);
+        worker->setProcessEnvironment(environment);
+        worker->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        worker->start(
+            QCoreApplication::applicationFilePath(),
+            QStringList(arguments) << "--workers" << QString::number(options.workers) << "--segment" << QString::number(i)
+        );
+
+        // If a worker cannot be started, its segment cannot be rendered, so the other
+        // workers are stopped.
+        if (!worker->waitForStarted(-1)) {
+            std::fprintf(stderr, "Could not start worker %u: %s\n", i, qPrintable(worker->errorString()));
+            for (auto& started : workers) {
+                started->kill();
+                started->waitForFinished(-1);
+            }
+            return 1;
+        }
+        workers.push_back(std::move(worker));
+    }
+
+    // A worker that crashed or failed to write a frame fails the run.
+    int status = 0;
+    for (auto& worker : workers) {
+        worker->waitForFinished(-1);
+        std::fputs(worker->readAllStandardOutput().constData(), stdout);
+        if (worker->error() != QProcess::UnknownError || worker->exitStatus() != QProcess::NormalExit || worker->exitCode() != 0)
+            status = 1;
+    }
+    const auto& seconds = timer.nsecsElapsed() * 1e-9;
+
+    std::printf(
+        "total: %u frames in %.2f s (%.1f fps) across %u %s workers\n",
+        options.frames, seconds, options.frames / seconds, options.workers, software ? "software" : "hardware"
+    );
+    return status;
+}
+
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(
+            stderr,
+            "Usage: %s [--frames N] [--fps F] [--workers W] [--encoders E] [--queue Q] [--output DIRECTORY] [--software]\n",
+            argv[0]
+        );
+        return 1;
+    }
+    if (options.segment < 0) {
+        QCoreApplication application(argc, argv);
+        return runCoordinator(options, application.arguments().mid(1));
+    } else {
+        QGuiApplication application(argc, argv);
+        return runWorker(options);
+    }
+}
+
+
+void
+StereoRenderer::initializeGL() {
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    glEnable(GL_CULL_FACE);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_LIGHTING);
+    glEnable(GL_LIGHT0);
+    glEnable(GL_COLOR_MATERIAL);
+    glShadeModel(GL_SMOOTH);
+
+    const GLfloat position[] = {0.0f, 5.0f, 0.0f, 0.0f};
+    glLightfv(GL_LIGHT0, GL_POSITION, position);
+}
+
+
+void
+StereoRenderer::paintGL(const ovrEyeType, const OVRWindow::RenderTransforms& transforms, const float) {
+    static const GLfloat vertices[6][4][3] = {
+        {{ 0.5f, 0.5f, 0.5f}, {-0.5f, 0.5f, 0.5f}, {-0.5f,-0.5f, 0.5f}, { 0.5f,-0.5f, 0.5f}},
+        {{-0.5f,-0.5f,-0.5f}, {-0.5f, 0.5f,-0.5f}, { 0.5f, 0.5f,-0.5f}, { 0.5f,-0.5f,-0.5f}},
+        {{ 0.5f, 0.5f, 0.5f}, { 0.5f, 0.5f,-0.5f}, {-0.5f, 0.5f,-0.5f}, {-0.5f, 0.5f, 0.5f}},
+        {{-0.5f,-0.5f,-0.5f}, { 0.5f,-0.5f,-0.5f}, { 0.5f,-0.5f, 0.5f}, {-0.5f,-0.5f, 0.5f}},
+        {{ 0.5f, 0.5f, 0.5f}, { 0.5f,-0.5f, 0.5f}, { 0.5f,-0.5f,-0.5f}, { 0.5f, 0.5f,-0.5f}},
+        {{-0.5f,-0.5f,-0.5f}, {-0.5f,-0.5f, 0.5f}, {-0.5f, 0.5f, 0.5f}, {-0.5f, 0.5f,-0.5f}},
+    };
+    static const GLfloat normals[6][3] = {
+        { 0.0f, 0.0f, 1.0f}, { 0.0f, 0.0f,-1.0f}, { 0.0f, 1.0f, 0.0f},
+        { 0.0f,-1.0f, 0.0f}, { 1.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f},
+    };
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadMatrixf(transforms.perspective.constData());
+    glMatrixMode(GL_MODELVIEW);
+
+    // Place eight cubes on a circle around the viewer.
+    const unsigned int count = 8;
+    for (unsigned int i = 0; i < count; ++i) {
+        const auto& angle = 360.0f * i / count;
+        const auto& radians = 6.2831853f * i / count;
+        glLoadMatrixf(transforms.view.constData());
+        glRotatef(angle, 0.0f, 1.0f, 0.0f);
+        glTranslatef(0.0f, 0.0f, -3.0f);
+        glRotatef(angle, 1.0f, 1.0f, 0.0f);
+        glColor3f(0.5f + 0.5f * std::cos(radians), 0.6f, 0.5f + 0.5f * std::sin(radians));
+
+        glBegin(GL_QUADS);
+        for (unsigned int face = 0; face < 6; ++face) {
+            glNormal3fv(normals[face]);
+            for (const auto& vertex : vertices[face]) {
+                glVertex3fv(vertex);
+            }
+        }
+        glEnd();
+    }
+}
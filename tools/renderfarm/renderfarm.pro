@@ -0,0 +1,20 @@
+# Path to the OVRWindow source code tree.
+OVRWINDOW = ../../src
+
+# OVRWindow configuration.
+include($$OVRWINDOW/ovrwindow.pri)
+
+# OVRWindow source.
+include($$OVRWINDOW/ovrwindow-sources.pri)
+
+# The render farm's build configuration.
+TEMPLATE = app
+TARGET = renderfarm
+CONFIG += console
+DESTDIR = build
+UI_DIR = $$DESTDIR/ui
+MOC_DIR = $$DESTDIR/moc
+OBJECTS_DIR = $$DESTDIR/obj
+QMAKE_CXXFLAGS += -Wall -Wextra
+LIBS += -lpthread
+SOURCES += main.cpp